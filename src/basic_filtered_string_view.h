@@ -0,0 +1,435 @@
+#ifndef COMP6771_ASS2_BASIC_FSV_H
+#define COMP6771_ASS2_BASIC_FSV_H
+
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <concepts>
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <type_traits>
+#include <utility>
+
+#include "./filtered_string_view.h"
+
+namespace fsv {
+	// The "true" predicate as a type, so that it can be inlined
+	struct keep_all {
+		constexpr auto operator()(const char&) const noexcept -> bool {
+			return true;
+		}
+	};
+
+	/**
+	 * A filtered_string_view whose predicate type is known at compile time.
+	 *
+	 * The predicate is stored by value rather than behind a std::function, so every loop
+	 * over the underlying data can inline it. Converts to the type-erased
+	 * filtered_string_view when the concrete predicate type no longer matters.
+	 *
+	 * It has only the core of filtered_string_view's API: construction, subscript, at, size,
+	 * empty, data, predicate, conversion to std::string, iteration, comparison and output. There
+	 * is no compiled table, index, copy_to, search, chunks, split, substr or compose; convert to
+	 * filtered_string_view for those.
+	 */
+	template<typename Pred = keep_all>
+	class basic_filtered_string_view {
+		class iter {
+		 public:
+			friend class basic_filtered_string_view;
+
+			using iterator_category = std::bidirectional_iterator_tag;
+			using value_type = char;
+			using pointer = void;
+			using reference = const char&;
+			using difference_type = std::ptrdiff_t;
+
+			iter() noexcept = default;
+
+			auto operator*() const noexcept -> reference;
+
+			auto operator++() noexcept -> iter&;
+			auto operator++(int) noexcept -> iter;
+			auto operator--() noexcept -> iter&;
+			auto operator--(int) noexcept -> iter;
+
+			friend auto operator==(const iter& lhs, const iter& rhs) noexcept -> bool {
+				return lhs.data_ == rhs.data_;
+			}
+
+		 private:
+			const char* data_ = nullptr;
+			const basic_filtered_string_view* owner_ = nullptr;
+
+			iter(const char* data, const basic_filtered_string_view* owner) noexcept;
+		};
+
+	 public:
+		// Default Constructor
+		basic_filtered_string_view() noexcept
+		requires std::default_initializable<Pred>;
+
+		// String Constructor
+		basic_filtered_string_view(const std::string& str, Pred predicate = Pred{}) noexcept;
+
+		// Null-Terminated String Constructor
+		basic_filtered_string_view(const char* str, Pred predicate = Pred{}) noexcept;
+
+		// Buffer Constructor
+		basic_filtered_string_view(const char* str, std::size_t size, Pred predicate = Pred{}) noexcept;
+
+		// Copy Constructor
+		basic_filtered_string_view(const basic_filtered_string_view& other) noexcept = default;
+
+		// Move Constructor
+		basic_filtered_string_view(basic_filtered_string_view&& other) noexcept;
+
+		// Destructor
+		~basic_filtered_string_view() noexcept = default;
+
+		/**
+		 * Member Operators Section
+		 */
+		// Copy Assignment
+		auto operator=(const basic_filtered_string_view& other) noexcept -> basic_filtered_string_view&
+		requires std::is_copy_assignable_v<Pred>;
+
+		// Move Assignment
+		auto operator=(basic_filtered_string_view&& other) noexcept -> basic_filtered_string_view&
+		requires std::is_move_assignable_v<Pred>;
+
+		// Subscript
+		// Requires n < size(), which is asserted, while a negative n reads the first kept char. Any
+		// integer type is an exact match for the template, and only std::size_t goes to the overload.
+		template<std::integral Index>
+		auto operator[](Index n) const noexcept -> const char&;
+		auto operator[](std::size_t n) const noexcept -> const char&;
+
+		// String Type Conversion
+		explicit operator std::string() const;
+
+		// Type-Erased View Conversion
+		operator filtered_string_view() const;
+
+		// Member Functions
+		template<std::integral Index>
+		[[nodiscard]] auto at(Index index) const -> const char&;
+		[[nodiscard]] auto at(std::size_t index) const -> const char&;
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+		[[nodiscard]] auto empty() const noexcept -> bool;
+		[[nodiscard]] auto data() const noexcept -> const char*;
+		[[nodiscard]] auto predicate() const noexcept -> const Pred&;
+
+		/**
+		 * Iterators Section
+		 */
+		using iterator = iter;
+		using const_iterator = iter;
+		using reverse_iterator = std::reverse_iterator<iterator>;
+		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+		auto begin() const noexcept -> iterator;
+		auto cbegin() const noexcept -> const_iterator;
+
+		auto end() const noexcept -> iterator;
+		auto cend() const noexcept -> const_iterator;
+
+		auto rbegin() const noexcept -> reverse_iterator;
+		auto crbegin() const noexcept -> const_reverse_iterator;
+
+		auto rend() const noexcept -> reverse_iterator;
+		auto crend() const noexcept -> const_reverse_iterator;
+
+	 private:
+		const char* data_;
+		std::size_t size_;
+		Pred predicate_;
+	};
+
+	/**
+	 * Non-Member Operators
+	 */
+	// Equality Comparison
+	template<typename L, typename R>
+	auto operator==(const basic_filtered_string_view<L>& lhs, const basic_filtered_string_view<R>& rhs) noexcept
+	    -> bool {
+		return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+	}
+
+	// Relational Comparison
+	template<typename L, typename R>
+	auto operator<=>(const basic_filtered_string_view<L>& lhs, const basic_filtered_string_view<R>& rhs) noexcept
+	    -> std::strong_ordering {
+		return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+	}
+
+	// Output Stream
+	template<typename Pred>
+	auto operator<<(std::ostream& os, const basic_filtered_string_view<Pred>& fsv) -> std::ostream& {
+		std::copy(fsv.begin(), fsv.end(), std::ostreambuf_iterator<char>(os));
+		return os;
+	}
+} // namespace fsv
+
+// Default Constructor
+template<typename Pred>
+fsv::basic_filtered_string_view<Pred>::basic_filtered_string_view() noexcept
+requires std::default_initializable<Pred>
+: data_{nullptr}
+, size_{0}
+, predicate_{} {}
+
+// String Constructor
+template<typename Pred>
+fsv::basic_filtered_string_view<Pred>::basic_filtered_string_view(const std::string& str, Pred predicate) noexcept
+: data_{str.data()}
+, size_{str.size()}
+, predicate_{std::move(predicate)} {}
+
+// Null-Terminated String Constructor
+template<typename Pred>
+fsv::basic_filtered_string_view<Pred>::basic_filtered_string_view(const char* str, Pred predicate) noexcept
+: data_{str}
+, size_{std::strlen(str)}
+, predicate_{std::move(predicate)} {}
+
+// Buffer Constructor
+template<typename Pred>
+fsv::basic_filtered_string_view<Pred>::basic_filtered_string_view(const char* str,
+                                                                  std::size_t size,
+                                                                  Pred predicate) noexcept
+: data_{str}
+, size_{size}
+, predicate_{std::move(predicate)} {}
+
+// Move Constructor
+template<typename Pred>
+fsv::basic_filtered_string_view<Pred>::basic_filtered_string_view(basic_filtered_string_view&& other) noexcept
+: data_{std::exchange(other.data_, nullptr)}
+, size_{std::exchange(other.size_, 0)}
+, predicate_{std::move(other.predicate_)} {}
+
+// Member Operator - Copy Assignment
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::operator=(const basic_filtered_string_view& other) noexcept
+    -> basic_filtered_string_view& requires std::is_copy_assignable_v<Pred> {
+	if (this != &other) {
+		data_ = other.data_;
+		size_ = other.size_;
+		predicate_ = other.predicate_;
+	}
+	return *this;
+}
+
+// Member Operator - Move Assignment
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::operator=(basic_filtered_string_view&& other) noexcept
+    -> basic_filtered_string_view& requires std::is_move_assignable_v<Pred> {
+	if (this != &other) {
+		data_ = std::exchange(other.data_, nullptr);
+		size_ = std::exchange(other.size_, 0);
+		predicate_ = std::move(other.predicate_);
+	}
+	return *this;
+}
+
+// Member Operator - Subscript
+template<typename Pred>
+template<std::integral Index>
+auto fsv::basic_filtered_string_view<Pred>::operator[](Index n) const noexcept -> const char& {
+	if constexpr (std::is_signed_v<Index>) {
+		return (*this)[static_cast<std::size_t>(std::max(n, Index{0}))];
+	}
+	else {
+		return (*this)[static_cast<std::size_t>(n)];
+	}
+}
+
+// Member Operator - Subscript
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::operator[](std::size_t n) const noexcept -> const char& {
+	auto it = begin();
+	for (; n > 0 and it != end(); --n) {
+		++it;
+	}
+	assert(it != end() and "basic_filtered_string_view::operator[]: index out of range");
+	return *it;
+}
+
+// Member Operator - String Type Conversion
+template<typename Pred>
+fsv::basic_filtered_string_view<Pred>::operator std::string() const {
+	auto filtered_string = std::string{};
+	filtered_string.reserve(size_);
+	std::copy_if(data_, data_ + size_, std::back_inserter(filtered_string), predicate_);
+	return filtered_string;
+}
+
+// Member Operator - Type-Erased View Conversion
+template<typename Pred>
+fsv::basic_filtered_string_view<Pred>::operator filtered_string_view() const {
+	if constexpr (std::is_same_v<Pred, keep_all>) {
+		return filtered_string_view{data_, size_};
+	}
+	else if constexpr (std::is_same_v<Pred, pure_filter>) {
+		return filtered_string_view{data_, size_, predicate_};
+	}
+	else {
+		return filtered_string_view{data_, size_, filter{predicate_}};
+	}
+}
+
+// Member Function - at
+template<typename Pred>
+template<std::integral Index>
+auto fsv::basic_filtered_string_view<Pred>::at(Index index) const -> const char& {
+	if constexpr (std::is_signed_v<Index>) {
+		if (index < 0) {
+			throw std::domain_error{"filtered_string_view::at(" + std::to_string(index) + "): invalid index"};
+		}
+	}
+	return at(static_cast<std::size_t>(index));
+}
+
+// Member Function - at
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::at(std::size_t index) const -> const char& {
+	auto position = index;
+	for (auto it = begin(); it != end(); ++it, --position) {
+		if (position == 0) {
+			return *it;
+		}
+	}
+	throw std::domain_error{"filtered_string_view::at(" + std::to_string(index) + "): invalid index"};
+}
+
+// Member Function - size
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::size() const noexcept -> std::size_t {
+	// A plain counting loop over a contiguous range, which the compiler can vectorize
+	// once predicate_ is inlined.
+	auto count = std::size_t{0};
+	for (auto i = std::size_t{0}; i < size_; ++i) {
+		count += static_cast<std::size_t>(static_cast<bool>(predicate_(data_[i])));
+	}
+	return count;
+}
+
+// Member Function - empty
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::empty() const noexcept -> bool {
+	return std::none_of(data_, data_ + size_, predicate_);
+}
+
+// Member Function - data
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::data() const noexcept -> const char* {
+	return data_;
+}
+
+// Member Function - predicate
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::predicate() const noexcept -> const Pred& {
+	return predicate_;
+}
+
+// Iterator
+template<typename Pred>
+fsv::basic_filtered_string_view<Pred>::iter::iter(const char* data, const basic_filtered_string_view* owner) noexcept
+: data_{std::find_if(data, owner->data_ + owner->size_, owner->predicate_)}
+, owner_{owner} {}
+
+// Member Operator - Dereference
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::iter::operator*() const noexcept -> reference {
+	return *data_;
+}
+
+// Member Operator - Pre-Increment
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::iter::operator++() noexcept -> iter& {
+	data_ = std::find_if(data_ + 1, owner_->data_ + owner_->size_, owner_->predicate_);
+	return *this;
+}
+
+// Member Operator - Post-Increment
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::iter::operator++(int) noexcept -> iter {
+	auto old_this = *this;
+	++*this;
+	return old_this;
+}
+
+// Member Operator - Pre-Decrement
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::iter::operator--() noexcept -> iter& {
+	while (data_ != owner_->data_) {
+		--data_;
+		if (owner_->predicate_(*data_)) {
+			break;
+		}
+	}
+	return *this;
+}
+
+// Member Operator - Post-Decrement
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::iter::operator--(int) noexcept -> iter {
+	auto old_this = *this;
+	--*this;
+	return old_this;
+}
+
+// Range - Normal Begin
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::begin() const noexcept -> iterator {
+	return iterator{data_, this};
+}
+
+// Range - Constant Begin
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::cbegin() const noexcept -> const_iterator {
+	return begin();
+}
+
+// Range - Normal End
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::end() const noexcept -> iterator {
+	return iterator{data_ + size_, this};
+}
+
+// Range - Constant End
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::cend() const noexcept -> const_iterator {
+	return end();
+}
+
+// Range - Reverse Begin
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::rbegin() const noexcept -> reverse_iterator {
+	return reverse_iterator{end()};
+}
+
+// Range - Constant Reverse Begin
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::crbegin() const noexcept -> const_reverse_iterator {
+	return rbegin();
+}
+
+// Range - Reverse End
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::rend() const noexcept -> reverse_iterator {
+	return reverse_iterator{begin()};
+}
+
+// Range - Constant Reverse End
+template<typename Pred>
+auto fsv::basic_filtered_string_view<Pred>::crend() const noexcept -> const_reverse_iterator {
+	return rend();
+}
+
+#endif // COMP6771_ASS2_BASIC_FSV_H
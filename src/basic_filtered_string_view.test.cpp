@@ -0,0 +1,135 @@
+#include "./basic_filtered_string_view.h"
+
+#include <array>
+#include <catch2/catch.hpp>
+#include <cstdint>
+#include <sstream>
+#include <vector>
+
+namespace {
+	struct is_digit {
+		auto operator()(const char& c) const noexcept -> bool {
+			return c >= '0' && c <= '9';
+		}
+	};
+} // namespace
+
+TEST_CASE("Basic - Default Constructor") {
+	const auto sv = fsv::basic_filtered_string_view{};
+	CHECK(sv.empty());
+	CHECK(sv.size() == 0);
+	CHECK(sv.data() == nullptr);
+}
+
+TEST_CASE("Basic - String Constructor") {
+	const auto s = std::string{"cat"};
+	const auto sv = fsv::basic_filtered_string_view{s};
+	CHECK(sv.size() == 3);
+	CHECK(sv.data() == s.data());
+}
+
+TEST_CASE("Basic - Constructor with Predicate") {
+	const auto sv = fsv::basic_filtered_string_view{"cat", [](const char& c) { return c == 'a'; }};
+	CHECK(sv.size() == 1);
+	CHECK(sv[0] == 'a');
+}
+
+TEST_CASE("Basic - Move Constructor") {
+	auto sv1 = fsv::basic_filtered_string_view{"bulldog"};
+	const auto move = std::move(sv1);
+	CHECK(sv1.data() == nullptr);
+	CHECK(sv1.empty());
+	CHECK(move.size() == 7);
+}
+
+TEST_CASE("Basic - Copy and Move Assignment") {
+	const auto fsv1 = fsv::basic_filtered_string_view<is_digit>{"42 bro"};
+	auto fsv2 = fsv::basic_filtered_string_view<is_digit>{};
+	fsv2 = fsv1;
+	CHECK(fsv1 == fsv2);
+	auto fsv3 = fsv::basic_filtered_string_view<is_digit>{};
+	fsv3 = std::move(fsv2);
+	CHECK(fsv2.data() == nullptr);
+	CHECK(static_cast<std::string>(fsv3) == "42");
+}
+
+TEST_CASE("Basic - Subscript and at") {
+	const auto sv = fsv::basic_filtered_string_view<is_digit>{"only 90s kids understand 1999"};
+	CHECK(sv[1] == '0');
+	CHECK(sv.at(2) == '1');
+	CHECK(sv.size() == 6);
+	CHECK_THROWS_MATCHES(sv.at(6),
+	                     std::domain_error,
+	                     Catch::Matchers::Message("filtered_string_view::at(6): invalid index"));
+	CHECK_THROWS_MATCHES(sv.at(-1),
+	                     std::domain_error,
+	                     Catch::Matchers::Message("filtered_string_view::at(-1): invalid index"));
+	CHECK(sv[std::size_t{1}] == '0');
+	CHECK(sv.at(std::ptrdiff_t{5}) == '9');
+	CHECK_THROWS_AS(sv.at(std::size_t{6}), std::domain_error);
+	CHECK(sv[2u] == '1');
+	CHECK(sv[1LL] == '0');
+	CHECK(sv.at(std::uint32_t{1}) == '0');
+	CHECK_THROWS_AS(sv.at(-1LL), std::domain_error);
+}
+
+TEST_CASE("Basic - buffer constructor stays inside an unterminated buffer") {
+	const auto buffer = std::array<char, 6>{'9', 'x', '0', 'y', '1', 'z'};
+	const auto sv = fsv::basic_filtered_string_view<is_digit>{buffer.data(), 4};
+	CHECK(sv.size() == 2);
+	CHECK(static_cast<std::string>(sv) == "90");
+	CHECK(sv[1] == '0');
+	CHECK_THROWS_AS(sv.at(2), std::domain_error);
+	CHECK(std::string(sv.rbegin(), sv.rend()) == "09");
+	CHECK(static_cast<fsv::filtered_string_view>(sv) == "90");
+}
+
+TEST_CASE("Basic - empty with predicate") {
+	const auto sv = fsv::basic_filtered_string_view{"Border Collie", [](const char& c) { return c == 'z'; }};
+	CHECK(sv.empty());
+}
+
+TEST_CASE("Basic - Comparison") {
+	const auto lo = fsv::basic_filtered_string_view{"aaa"};
+	const auto hi = fsv::basic_filtered_string_view{"z1z2z3", [](const char& c) { return c == 'z'; }};
+	CHECK(lo != hi);
+	CHECK(lo < hi);
+	CHECK((hi <=> fsv::basic_filtered_string_view{"zzz"}) == std::strong_ordering::equal);
+}
+
+TEST_CASE("Basic - Output Stream") {
+	const auto sv = fsv::basic_filtered_string_view{"c++ > rust > java", [](const char& c) { return c == 'c' || c == '+'; }};
+	auto out = std::ostringstream{};
+	out << sv;
+	CHECK(out.str() == "c++");
+}
+
+TEST_CASE("Basic - Iterator") {
+	const auto sv = fsv::basic_filtered_string_view{"samoyed", [](const char& c) {
+		                                                return !(c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u');
+	                                                }};
+	CHECK(std::string(sv.begin(), sv.end()) == "smyd");
+	CHECK(std::string(sv.rbegin(), sv.rend()) == "dyms");
+	CHECK(*std::prev(sv.end()) == 'd');
+	static_assert(std::bidirectional_iterator<decltype(sv.begin())>);
+	static_assert(std::is_trivially_copyable_v<decltype(sv.begin())>);
+	static_assert(sizeof(decltype(sv.begin())) == 2 * sizeof(void*));
+}
+
+TEST_CASE("Basic - Conversion to filtered_string_view") {
+	const auto s = std::string{"0xDEADBEEF / 0xdeadbeef"};
+	const auto typed = fsv::basic_filtered_string_view<is_digit>{s};
+	const fsv::filtered_string_view erased = typed;
+	CHECK(erased.data() == s.data());
+	CHECK(erased == "00");
+	CHECK(!erased.table().has_value());
+
+	const fsv::filtered_string_view unfiltered = fsv::basic_filtered_string_view{s};
+	CHECK(unfiltered.table() == fsv::byte_set::all());
+	CHECK(unfiltered == s);
+
+	const auto pure = fsv::basic_filtered_string_view{s, fsv::pure_filter{is_digit{}}};
+	const fsv::filtered_string_view compiled = pure;
+	CHECK(compiled.table().has_value());
+	CHECK(compiled.size() == 2);
+}
@@ -0,0 +1,717 @@
+#include "./byte_kernels.h"
+
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cstdint>
+#include <cstring>
+#include <optional>
+
+#if defined(__x86_64__) || defined(__i386__)
+#	define FSV_X86_KERNELS 1
+#	include <immintrin.h>
+#endif
+
+namespace {
+	using fsv::byte_set;
+	using fsv::detail::byte_kernel;
+
+	// Below this many bytes, building the vector lookup tables costs more than it saves.
+	constexpr auto simd_threshold = std::size_t{32};
+
+	/**
+	 * Counts members of set with one table lookup per byte. Four independent
+	 * accumulators let consecutive lookups overlap instead of serialising on one sum.
+	 */
+	auto count_scalar(const char* first, std::size_t count, const byte_set& set) noexcept -> std::size_t {
+		auto partial = std::array<std::size_t, 4>{};
+		auto i = std::size_t{0};
+		for (; i + partial.size() <= count; i += partial.size()) {
+			partial[0] += static_cast<std::size_t>(set.contains(first[i]));
+			partial[1] += static_cast<std::size_t>(set.contains(first[i + 1]));
+			partial[2] += static_cast<std::size_t>(set.contains(first[i + 2]));
+			partial[3] += static_cast<std::size_t>(set.contains(first[i + 3]));
+		}
+		for (; i < count; ++i) {
+			partial[0] += static_cast<std::size_t>(set.contains(first[i]));
+		}
+		return partial[0] + partial[1] + partial[2] + partial[3];
+	}
+
+	auto find_scalar(const char* first, std::size_t count, const byte_set& set) noexcept -> std::size_t {
+		auto i = std::size_t{0};
+		while (i < count and not set.contains(first[i])) {
+			++i;
+		}
+		return i;
+	}
+
+	// Branch-free: every byte is written, but only members advance the output position.
+	auto compact_scalar(const char* first, std::size_t count, const byte_set& set, char* out, std::size_t capacity) noexcept
+	    -> std::size_t {
+		auto written = std::size_t{0};
+		for (auto i = std::size_t{0}; i < count and written < capacity; ++i) {
+			out[written] = first[i];
+			written += static_cast<std::size_t>(set.contains(first[i]));
+		}
+		return written;
+	}
+
+	auto find_substring_scalar(const char* first, std::size_t count, const char* needle, std::size_t needle_count) noexcept
+	    -> std::size_t {
+		return static_cast<std::size_t>(std::search(first, first + count, needle, needle + needle_count) - first);
+	}
+
+	__extension__ using uint128 = unsigned __int128;
+
+	// splitmix64, so the hash keys come from one seed rather than a table of magic numbers
+	constexpr auto splitmix(std::uint64_t& state) noexcept -> std::uint64_t {
+		state += 0x9E3779B97F4A7C15U;
+		auto z = state;
+		z = (z ^ (z >> 30U)) * 0xBF58476D1CE4E5B9U;
+		z = (z ^ (z >> 27U)) * 0x94D049BB133111EBU;
+		return z ^ (z >> 31U);
+	}
+
+	struct hash_keys {
+		std::array<std::uint64_t, 8> start;
+		std::array<std::uint64_t, 8> stripe;
+		std::array<std::uint64_t, 8> scramble;
+		std::array<std::uint64_t, 8> mix;
+	};
+
+	constexpr auto keys = [] {
+		auto state = std::uint64_t{0x6673762D68617368U};
+		auto result = hash_keys{};
+		for (auto* part : {&result.start, &result.stripe, &result.scramble, &result.mix}) {
+			for (auto& key : *part) {
+				key = splitmix(state);
+			}
+		}
+		return result;
+	}();
+
+	// Stripes folded between two scrambles of the lanes
+	constexpr auto stripes_per_scramble = std::uint64_t{16};
+	constexpr auto scramble_prime = std::uint64_t{0x9E3779B1U};
+
+	auto load64(const char* data) noexcept -> std::uint64_t {
+		auto word = std::uint64_t{0};
+		std::memcpy(&word, data, sizeof(word));
+		return word;
+	}
+
+	auto load32(const char* data) noexcept -> std::uint64_t {
+		auto word = std::uint32_t{0};
+		std::memcpy(&word, data, sizeof(word));
+		return word;
+	}
+
+	// Both halves of the 128-bit product of a and b, folded together
+	auto mix(std::uint64_t a, std::uint64_t b) noexcept -> std::uint64_t {
+		const auto product = static_cast<uint128>(a) * b;
+		return static_cast<std::uint64_t>(product) ^ static_cast<std::uint64_t>(product >> 64U);
+	}
+
+	/**
+	 * Folds stripes 64-byte stripes from first into lanes. Each lane adds the product of the low
+	 * and high halves of its keyed word, and its neighbour adds the raw word, so no input bit is
+	 * lost to a zero product. index is the number of stripes folded before these.
+	 */
+	auto fold_scalar(std::array<std::uint64_t, 8>& lanes, const char* first, std::size_t stripes, std::uint64_t index) noexcept
+	    -> void {
+		for (auto s = std::size_t{0}; s < stripes; ++s, first += 64) {
+			for (auto i = std::size_t{0}; i < lanes.size(); ++i) {
+				const auto word = load64(first + 8 * i);
+				const auto keyed = word ^ keys.stripe[i];
+				lanes[i ^ 1U] += word;
+				lanes[i] += (keyed & 0xFFFFFFFFU) * (keyed >> 32U);
+			}
+			if (++index % stripes_per_scramble == 0) {
+				for (auto i = std::size_t{0}; i < lanes.size(); ++i) {
+					lanes[i] = (lanes[i] ^ (lanes[i] >> 47U) ^ keys.scramble[i]) * scramble_prime;
+				}
+			}
+		}
+	}
+
+#ifdef FSV_X86_KERNELS
+	// A byte_set as at most eight inclusive [low, high] pairs, the needle format of pcmpestrm
+	struct byte_ranges {
+		std::array<char, 16> bounds;
+		int length;
+	};
+
+	auto to_ranges(const byte_set& set) noexcept -> std::optional<byte_ranges> {
+		auto ranges = byte_ranges{{}, 0};
+		auto value = 0;
+		while (value < 256) {
+			if (not set.contains(static_cast<char>(value))) {
+				++value;
+				continue;
+			}
+			auto last = value;
+			while (last + 1 < 256 and set.contains(static_cast<char>(last + 1))) {
+				++last;
+			}
+			if (ranges.length == static_cast<int>(ranges.bounds.size())) {
+				return std::nullopt;
+			}
+			ranges.bounds[static_cast<std::size_t>(ranges.length++)] = static_cast<char>(value);
+			ranges.bounds[static_cast<std::size_t>(ranges.length++)] = static_cast<char>(last);
+			value = last + 1;
+		}
+		return ranges;
+	}
+
+	[[gnu::target("sse4.2")]] auto
+	count_sse42(const char* first, std::size_t count, const byte_set& set, const byte_ranges& ranges) noexcept
+	    -> std::size_t {
+		const auto needle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ranges.bounds.data()));
+		auto result = std::size_t{0};
+		auto i = std::size_t{0};
+		for (; i + 16 <= count; i += 16) {
+			const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+			const auto mask =
+			    _mm_cmpestrm(needle, ranges.length, block, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_BIT_MASK);
+			result += static_cast<std::size_t>(std::popcount(static_cast<std::uint32_t>(_mm_cvtsi128_si32(mask))));
+		}
+		return result + count_scalar(first + i, count - i, set);
+	}
+
+	[[gnu::target("sse4.2")]] auto
+	find_sse42(const char* first, std::size_t count, const byte_set& set, const byte_ranges& ranges) noexcept
+	    -> std::size_t {
+		const auto needle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ranges.bounds.data()));
+		auto i = std::size_t{0};
+		for (; i + 16 <= count; i += 16) {
+			const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+			const auto index =
+			    _mm_cmpestri(needle, ranges.length, block, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_LEAST_SIGNIFICANT);
+			if (index != 16) {
+				return i + static_cast<std::size_t>(index);
+			}
+		}
+		return i + find_scalar(first + i, count - i, set);
+	}
+
+	/**
+	 * A byte_set split by the low nibble of each value: bit h of low[l] says whether
+	 * (h << 4 | l) is a member for h < 8, and bit h of high[l] does the same for h + 8.
+	 * This is the layout the pshufb classification below looks up.
+	 */
+	struct nibble_tables {
+		std::array<std::uint8_t, 16> low;
+		std::array<std::uint8_t, 16> high;
+	};
+
+	auto to_nibble_tables(const byte_set& set) noexcept -> nibble_tables {
+		auto tables = nibble_tables{{}, {}};
+		for (auto w = std::size_t{0}; w < set.words().size(); ++w) {
+			for (auto word = set.words()[w]; word != 0; word &= word - 1) {
+				const auto value = w * 64 + static_cast<std::size_t>(std::countr_zero(word));
+				const auto hi = value >> 4U;
+				auto& row = hi < 8 ? tables.low : tables.high;
+				row[value & 15U] = static_cast<std::uint8_t>(row[value & 15U] | (1U << (hi & 7U)));
+			}
+		}
+		return tables;
+	}
+
+	// The nibble tables broadcast to both 128-bit lanes, as _mm256_shuffle_epi8 shuffles per lane
+	struct avx2_tables {
+		__m256i low;
+		__m256i high;
+	};
+
+	[[gnu::target("avx2")]] auto load_avx2_tables(const nibble_tables& tables) noexcept -> avx2_tables {
+		return avx2_tables{
+		    _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.low.data()))),
+		    _mm256_broadcastsi128_si256(_mm_loadu_si128(reinterpret_cast<const __m128i*>(tables.high.data())))};
+	}
+
+	// One bit per member of the 32 bytes at data
+	[[gnu::target("avx2")]] auto classify_avx2(const char* data, const avx2_tables& tables) noexcept -> std::uint32_t {
+		const auto nibble = _mm256_set1_epi8(0x0F);
+		const auto bits = _mm256_setr_epi8(1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128,
+		                                   1, 2, 4, 8, 16, 32, 64, -128, 1, 2, 4, 8, 16, 32, 64, -128);
+		const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+		const auto lo = _mm256_and_si256(block, nibble);
+		const auto hi = _mm256_and_si256(_mm256_srli_epi16(block, 4), nibble);
+		const auto row = _mm256_blendv_epi8(_mm256_shuffle_epi8(tables.low, lo),
+		                                    _mm256_shuffle_epi8(tables.high, lo),
+		                                    _mm256_cmpgt_epi8(hi, _mm256_set1_epi8(7)));
+		const auto bit = _mm256_shuffle_epi8(bits, hi);
+		const auto member = _mm256_cmpeq_epi8(_mm256_and_si256(row, bit), bit);
+		return static_cast<std::uint32_t>(_mm256_movemask_epi8(member));
+	}
+
+	[[gnu::target("avx2")]] auto count_avx2(const char* first, std::size_t count, const byte_set& set) noexcept
+	    -> std::size_t {
+		const auto tables = load_avx2_tables(to_nibble_tables(set));
+		auto result = std::size_t{0};
+		auto i = std::size_t{0};
+		for (; i + 32 <= count; i += 32) {
+			result += static_cast<std::size_t>(std::popcount(classify_avx2(first + i, tables)));
+		}
+		return result + count_scalar(first + i, count - i, set);
+	}
+
+	[[gnu::target("avx2")]] auto find_avx2(const char* first, std::size_t count, const byte_set& set) noexcept
+	    -> std::size_t {
+		const auto tables = load_avx2_tables(to_nibble_tables(set));
+		auto i = std::size_t{0};
+		for (; i + 32 <= count; i += 32) {
+			if (const auto mask = classify_avx2(first + i, tables); mask != 0) {
+				return i + static_cast<std::size_t>(std::countr_zero(mask));
+			}
+		}
+		return i + find_scalar(first + i, count - i, set);
+	}
+
+	// For every 8-bit mask, the pshufb indices that move the selected bytes to the front
+	constexpr auto compress_shuffles = [] {
+		auto table = std::array<std::array<std::uint8_t, 8>, 256>{};
+		for (auto mask = std::size_t{0}; mask < table.size(); ++mask) {
+			auto packed = std::size_t{0};
+			for (auto bit = std::size_t{0}; bit < 8; ++bit) {
+				if (((mask >> bit) & 1U) != 0) {
+					table[mask][packed++] = static_cast<std::uint8_t>(bit);
+				}
+			}
+			for (; packed < 8; ++packed) {
+				table[mask][packed] = 0x80;
+			}
+		}
+		return table;
+	}();
+
+	/**
+	 * Packs the bytes of block selected by the low 16 bits of mask to the front of out and
+	 * returns how many there were. Each half of the block is packed with one pshufb and
+	 * written with one 8-byte store, so out needs 16 bytes of room whatever the count.
+	 */
+	[[gnu::target("ssse3")]] auto compress16(__m128i block, std::uint32_t mask, char* out) noexcept -> std::size_t {
+		const auto low_mask = mask & 0xFFU;
+		const auto high_mask = (mask >> 8U) & 0xFFU;
+		auto low_shuffle = std::uint64_t{0};
+		auto high_shuffle = std::uint64_t{0};
+		std::memcpy(&low_shuffle, compress_shuffles[low_mask].data(), sizeof(low_shuffle));
+		std::memcpy(&high_shuffle, compress_shuffles[high_mask].data(), sizeof(high_shuffle));
+		// Indices into the high half are offset by 8; the 0x80 "zero" entries stay negative.
+		high_shuffle += 0x0808080808080808U;
+		const auto packed = _mm_shuffle_epi8(
+		    block, _mm_set_epi64x(static_cast<long long>(high_shuffle), static_cast<long long>(low_shuffle)));
+		const auto low_count = static_cast<std::size_t>(std::popcount(low_mask));
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(out), packed);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(out + low_count), _mm_unpackhi_epi64(packed, packed));
+		return low_count + static_cast<std::size_t>(std::popcount(high_mask));
+	}
+
+	// As compress16, but writes exactly min(count, capacity) bytes to out
+	[[gnu::target("ssse3")]] auto
+	compress16_bounded(__m128i block, std::uint32_t mask, char* out, std::size_t capacity) noexcept -> std::size_t {
+		if (capacity >= 16) {
+			return compress16(block, mask, out);
+		}
+		auto packed = std::array<char, 16>{};
+		const auto count = std::min(compress16(block, mask, packed.data()), capacity);
+		std::memcpy(out, packed.data(), count);
+		return count;
+	}
+
+	[[gnu::target("sse4.2")]] auto compact_sse42(const char* first,
+	                                             std::size_t count,
+	                                             const byte_set& set,
+	                                             const byte_ranges& ranges,
+	                                             char* out,
+	                                             std::size_t capacity) noexcept -> std::size_t {
+		const auto needle = _mm_loadu_si128(reinterpret_cast<const __m128i*>(ranges.bounds.data()));
+		auto written = std::size_t{0};
+		auto i = std::size_t{0};
+		for (; i + 16 <= count and written < capacity; i += 16) {
+			const auto block = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+			const auto mask =
+			    _mm_cmpestrm(needle, ranges.length, block, 16, _SIDD_UBYTE_OPS | _SIDD_CMP_RANGES | _SIDD_BIT_MASK);
+			written += compress16_bounded(block,
+			                              static_cast<std::uint32_t>(_mm_cvtsi128_si32(mask)),
+			                              out + written,
+			                              capacity - written);
+		}
+		return written + compact_scalar(first + i, count - i, set, out + written, capacity - written);
+	}
+
+	[[gnu::target("avx2")]] auto
+	compact_avx2(const char* first, std::size_t count, const byte_set& set, char* out, std::size_t capacity) noexcept
+	    -> std::size_t {
+		const auto tables = load_avx2_tables(to_nibble_tables(set));
+		auto written = std::size_t{0};
+		auto i = std::size_t{0};
+		for (; i + 32 <= count and written < capacity; i += 32) {
+			const auto mask = classify_avx2(first + i, tables);
+			const auto low = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i));
+			const auto high = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i + 16));
+			written += compress16_bounded(low, mask & 0xFFFFU, out + written, capacity - written);
+			written += compress16_bounded(high, mask >> 16U, out + written, capacity - written);
+		}
+		return written + compact_scalar(first + i, count - i, set, out + written, capacity - written);
+	}
+
+	// vpcompressb packs a whole 32-byte block, and a masked store writes only the kept bytes.
+	[[gnu::target("avx2,avx512f,avx512bw,avx512vl,avx512vbmi2")]] auto
+	compact_avx512(const char* first, std::size_t count, const byte_set& set, char* out, std::size_t capacity) noexcept
+	    -> std::size_t {
+		const auto tables = load_avx2_tables(to_nibble_tables(set));
+		auto written = std::size_t{0};
+		auto i = std::size_t{0};
+		for (; i + 32 <= count and written < capacity; i += 32) {
+			const auto mask = classify_avx2(first + i, tables);
+			const auto block = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i));
+			const auto kept = std::min(static_cast<std::size_t>(std::popcount(mask)), capacity - written);
+			const auto store_mask = kept == 32 ? ~std::uint32_t{0} : (std::uint32_t{1} << kept) - 1;
+			_mm256_mask_storeu_epi8(out + written, store_mask, _mm256_maskz_compress_epi8(mask, block));
+			written += kept;
+		}
+		return written + compact_scalar(first + i, count - i, set, out + written, capacity - written);
+	}
+
+	/**
+	 * Substring search by first and last byte: a block of candidate start positions is kept
+	 * only where both the needle's first byte and its last byte line up, and just those
+	 * candidates are compared in full. Needles of at least two bytes only.
+	 */
+	[[gnu::target("sse4.2")]] auto find_substring_sse42(const char* first,
+	                                                    std::size_t count,
+	                                                    const char* needle,
+	                                                    std::size_t needle_count) noexcept -> std::size_t {
+		const auto head = _mm_set1_epi8(needle[0]);
+		const auto tail = _mm_set1_epi8(needle[needle_count - 1]);
+		auto i = std::size_t{0};
+		for (; i + needle_count - 1 + 16 <= count; i += 16) {
+			const auto starts = _mm_cmpeq_epi8(head, _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i)));
+			const auto ends = _mm_cmpeq_epi8(
+			    tail,
+			    _mm_loadu_si128(reinterpret_cast<const __m128i*>(first + i + needle_count - 1)));
+			auto mask = static_cast<std::uint32_t>(_mm_movemask_epi8(_mm_and_si128(starts, ends)));
+			while (mask != 0) {
+				const auto offset = i + static_cast<std::size_t>(std::countr_zero(mask));
+				if (std::memcmp(first + offset + 1, needle + 1, needle_count - 2) == 0) {
+					return offset;
+				}
+				mask &= mask - 1;
+			}
+		}
+		return i + find_substring_scalar(first + i, count - i, needle, needle_count);
+	}
+
+	[[gnu::target("avx2")]] auto find_substring_avx2(const char* first,
+	                                                 std::size_t count,
+	                                                 const char* needle,
+	                                                 std::size_t needle_count) noexcept -> std::size_t {
+		const auto head = _mm256_set1_epi8(needle[0]);
+		const auto tail = _mm256_set1_epi8(needle[needle_count - 1]);
+		auto i = std::size_t{0};
+		for (; i + needle_count - 1 + 32 <= count; i += 32) {
+			const auto starts =
+			    _mm256_cmpeq_epi8(head, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i)));
+			const auto ends = _mm256_cmpeq_epi8(
+			    tail,
+			    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(first + i + needle_count - 1)));
+			auto mask = static_cast<std::uint32_t>(_mm256_movemask_epi8(_mm256_and_si256(starts, ends)));
+			while (mask != 0) {
+				const auto offset = i + static_cast<std::size_t>(std::countr_zero(mask));
+				if (std::memcmp(first + offset + 1, needle + 1, needle_count - 2) == 0) {
+					return offset;
+				}
+				mask &= mask - 1;
+			}
+		}
+		return i + find_substring_scalar(first + i, count - i, needle, needle_count);
+	}
+#endif
+
+#ifdef FSV_X86_KERNELS
+	// One half of a stripe folded into four lanes, as fold_scalar does
+	[[gnu::target("avx2")]] auto accumulate_avx2(__m256i lanes, const char* data, __m256i key) noexcept -> __m256i {
+		const auto word = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data));
+		const auto keyed = _mm256_xor_si256(word, key);
+		const auto product = _mm256_mul_epu32(keyed, _mm256_srli_epi64(keyed, 32));
+		const auto neighbour = _mm256_shuffle_epi32(word, _MM_SHUFFLE(1, 0, 3, 2));
+		return _mm256_add_epi64(lanes, _mm256_add_epi64(product, neighbour));
+	}
+
+	[[gnu::target("avx2")]] auto scramble_avx2(__m256i lanes, __m256i key) noexcept -> __m256i {
+		const auto prime = _mm256_set1_epi64x(static_cast<long long>(scramble_prime));
+		const auto mixed = _mm256_xor_si256(_mm256_xor_si256(lanes, _mm256_srli_epi64(lanes, 47)), key);
+		// A 64x32-bit multiply from two 32x32->64 ones
+		return _mm256_add_epi64(_mm256_mul_epu32(mixed, prime),
+		                        _mm256_slli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(mixed, 32), prime), 32));
+	}
+
+	// fold_scalar, four lanes to a vector
+	[[gnu::target("avx2")]] auto
+	fold_avx2(std::array<std::uint64_t, 8>& lanes, const char* first, std::size_t stripes, std::uint64_t index) noexcept
+	    -> void {
+		auto* lane_data = reinterpret_cast<__m256i*>(lanes.data());
+		const auto* stripe_keys = reinterpret_cast<const __m256i*>(keys.stripe.data());
+		const auto* scramble_keys = reinterpret_cast<const __m256i*>(keys.scramble.data());
+		auto low = _mm256_loadu_si256(lane_data);
+		auto high = _mm256_loadu_si256(lane_data + 1);
+		const auto stripe_low = _mm256_loadu_si256(stripe_keys);
+		const auto stripe_high = _mm256_loadu_si256(stripe_keys + 1);
+		for (auto s = std::size_t{0}; s < stripes; ++s, first += 64) {
+			low = accumulate_avx2(low, first, stripe_low);
+			high = accumulate_avx2(high, first + 32, stripe_high);
+			if (++index % stripes_per_scramble == 0) {
+				low = scramble_avx2(low, _mm256_loadu_si256(scramble_keys));
+				high = scramble_avx2(high, _mm256_loadu_si256(scramble_keys + 1));
+			}
+		}
+		_mm256_storeu_si256(lane_data, low);
+		_mm256_storeu_si256(lane_data + 1, high);
+	}
+#endif
+
+	auto detect_best_kernel() noexcept -> byte_kernel {
+#ifdef FSV_X86_KERNELS
+		__builtin_cpu_init();
+		if (__builtin_cpu_supports("avx512vbmi2") and __builtin_cpu_supports("avx512vl")
+		    and __builtin_cpu_supports("avx512bw"))
+		{
+			return byte_kernel::avx512vbmi2;
+		}
+		if (__builtin_cpu_supports("avx2")) {
+			return byte_kernel::avx2;
+		}
+		if (__builtin_cpu_supports("sse4.2")) {
+			return byte_kernel::sse42;
+		}
+#endif
+		return byte_kernel::scalar;
+	}
+} // namespace
+
+// Kernel Selection - best_byte_kernel
+auto fsv::detail::best_byte_kernel() noexcept -> byte_kernel {
+	static const auto kernel = detect_best_kernel();
+	return kernel;
+}
+
+// Kernel Selection - supports
+auto fsv::detail::supports(byte_kernel kernel) noexcept -> bool {
+	return static_cast<int>(kernel) <= static_cast<int>(best_byte_kernel());
+}
+
+// Kernel - count_in_set
+auto fsv::detail::count_in_set(const char* first, std::size_t count, const byte_set& set, byte_kernel kernel) noexcept
+    -> std::size_t {
+	if (set == byte_set{}) {
+		return 0;
+	}
+	if (set == byte_set::all()) {
+		return count;
+	}
+	if (count < simd_threshold) {
+		return count_scalar(first, count, set);
+	}
+#ifdef FSV_X86_KERNELS
+	switch (kernel) {
+	case byte_kernel::avx512vbmi2:
+	case byte_kernel::avx2: return count_avx2(first, count, set);
+	case byte_kernel::sse42:
+		if (const auto ranges = to_ranges(set); ranges.has_value()) {
+			return count_sse42(first, count, set, *ranges);
+		}
+		break;
+	case byte_kernel::scalar: break;
+	}
+#else
+	static_cast<void>(kernel);
+#endif
+	return count_scalar(first, count, set);
+}
+
+// Kernel - find_in_set
+auto fsv::detail::find_in_set(const char* first, std::size_t count, const byte_set& set, byte_kernel kernel) noexcept
+    -> std::size_t {
+	if (set == byte_set{}) {
+		return count;
+	}
+	if (set == byte_set::all() or count < simd_threshold) {
+		return find_scalar(first, count, set);
+	}
+#ifdef FSV_X86_KERNELS
+	switch (kernel) {
+	case byte_kernel::avx512vbmi2:
+	case byte_kernel::avx2: return find_avx2(first, count, set);
+	case byte_kernel::sse42:
+		if (const auto ranges = to_ranges(set); ranges.has_value()) {
+			return find_sse42(first, count, set, *ranges);
+		}
+		break;
+	case byte_kernel::scalar: break;
+	}
+#else
+	static_cast<void>(kernel);
+#endif
+	return find_scalar(first, count, set);
+}
+
+// Kernel - find_substring
+auto fsv::detail::find_substring(const char* first,
+                                 std::size_t count,
+                                 const char* needle,
+                                 std::size_t needle_count,
+                                 byte_kernel kernel) noexcept -> std::size_t {
+	if (needle_count == 0) {
+		return 0;
+	}
+	if (needle_count > count) {
+		return count;
+	}
+	if (needle_count == 1) {
+		const auto* found = static_cast<const char*>(std::memchr(first, needle[0], count));
+		return found == nullptr ? count : static_cast<std::size_t>(found - first);
+	}
+	if (count < simd_threshold) {
+		return find_substring_scalar(first, count, needle, needle_count);
+	}
+#ifdef FSV_X86_KERNELS
+	switch (kernel) {
+	case byte_kernel::avx512vbmi2:
+	case byte_kernel::avx2: return find_substring_avx2(first, count, needle, needle_count);
+	case byte_kernel::sse42: return find_substring_sse42(first, count, needle, needle_count);
+	case byte_kernel::scalar: break;
+	}
+#else
+	static_cast<void>(kernel);
+#endif
+	return find_substring_scalar(first, count, needle, needle_count);
+}
+
+// Kernel - compact_in_set
+auto fsv::detail::compact_in_set(const char* first,
+                                 std::size_t count,
+                                 const byte_set& set,
+                                 char* out,
+                                 std::size_t capacity,
+                                 byte_kernel kernel) noexcept -> std::size_t {
+	if (set == byte_set::all()) {
+		const auto copied = std::min(count, capacity);
+		if (copied == 0) {
+			// first and out may be null here, which memcpy does not allow even for zero bytes.
+			return 0;
+		}
+		std::memcpy(out, first, copied);
+		return copied;
+	}
+	if (set == byte_set{}) {
+		return 0;
+	}
+	if (count < simd_threshold) {
+		return compact_scalar(first, count, set, out, capacity);
+	}
+#ifdef FSV_X86_KERNELS
+	switch (kernel) {
+	case byte_kernel::avx512vbmi2: return compact_avx512(first, count, set, out, capacity);
+	case byte_kernel::avx2: return compact_avx2(first, count, set, out, capacity);
+	case byte_kernel::sse42:
+		if (const auto ranges = to_ranges(set); ranges.has_value()) {
+			return compact_sse42(first, count, set, *ranges, out, capacity);
+		}
+		break;
+	case byte_kernel::scalar: break;
+	}
+#else
+	static_cast<void>(kernel);
+#endif
+	return compact_scalar(first, count, set, out, capacity);
+}
+
+// Hash Stream - Constructor
+fsv::detail::hash_stream::hash_stream() noexcept
+: lanes_{keys.start}
+, stripes_{0}
+, pending_{}
+, pending_size_{0} {}
+
+// Hash Stream - update
+auto fsv::detail::hash_stream::update(const char* first, std::size_t count, byte_kernel kernel) noexcept -> void {
+	if (count == 0) {
+		return;
+	}
+	auto fold = [this, kernel](const char* data, std::size_t stripes) {
+#ifdef FSV_X86_KERNELS
+		if (kernel == byte_kernel::avx2 or kernel == byte_kernel::avx512vbmi2) {
+			fold_avx2(lanes_, data, stripes, stripes_);
+			stripes_ += stripes;
+			return;
+		}
+#else
+		static_cast<void>(kernel);
+#endif
+		fold_scalar(lanes_, data, stripes, stripes_);
+		stripes_ += stripes;
+	};
+
+	// A stripe is folded as soon as it is complete, wherever its bytes came from.
+	if (pending_size_ != 0) {
+		const auto taken = std::min(stripe - pending_size_, count);
+		std::memcpy(pending_.data() + pending_size_, first, taken);
+		pending_size_ += taken;
+		first += taken;
+		count -= taken;
+		if (pending_size_ < stripe) {
+			return;
+		}
+		fold(pending_.data(), 1);
+		pending_size_ = 0;
+	}
+	const auto whole = count / stripe;
+	fold(first, whole);
+	pending_size_ = count - whole * stripe;
+	std::memcpy(pending_.data(), first + whole * stripe, pending_size_);
+}
+
+// Hash Stream - digest
+auto fsv::detail::hash_stream::digest() const noexcept -> std::uint64_t {
+	const auto length = stripes_ * stripe + pending_size_;
+	auto hash = mix(length ^ keys.mix[0], keys.mix[1]);
+
+	// The tail, 16 bytes at a time and then as two overlapping words
+	const auto* tail = pending_.data();
+	auto left = pending_size_;
+	for (; left >= 16; tail += 16, left -= 16) {
+		hash ^= mix(load64(tail) ^ keys.mix[2], load64(tail + 8) ^ hash);
+	}
+	auto low = std::uint64_t{0};
+	auto high = std::uint64_t{0};
+	if (left >= 8) {
+		low = load64(tail);
+		high = load64(tail + left - 8);
+	}
+	else if (left >= 4) {
+		low = load32(tail);
+		high = load32(tail + left - 4);
+	}
+	else if (left > 0) {
+		low = std::uint64_t{static_cast<unsigned char>(tail[0])} << 16U
+		      | std::uint64_t{static_cast<unsigned char>(tail[left / 2])} << 8U
+		      | std::uint64_t{static_cast<unsigned char>(tail[left - 1])};
+	}
+	hash ^= mix(low ^ keys.mix[3], high ^ hash);
+
+	if (stripes_ != 0) {
+		for (auto i = std::size_t{0}; i < lanes_.size(); i += 2) {
+			hash ^= mix(lanes_[i] ^ keys.mix[4 + i / 2], lanes_[i + 1] ^ hash);
+		}
+	}
+	return mix(hash ^ keys.mix[2], length ^ keys.mix[3]);
+}
+
+// Kernel - hash_bytes
+auto fsv::detail::hash_bytes(const char* first, std::size_t count, byte_kernel kernel) noexcept -> std::uint64_t {
+	auto stream = hash_stream{};
+	stream.update(first, count, kernel);
+	return stream.digest();
+}
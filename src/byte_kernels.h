@@ -0,0 +1,92 @@
+#ifndef COMP6771_ASS2_BYTE_KERNELS_H
+#define COMP6771_ASS2_BYTE_KERNELS_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "./byte_set.h"
+
+namespace fsv::detail {
+	/**
+	 * Instruction set used to classify bytes against a byte_set.
+	 *
+	 * avx2 handles any set with a nibble lookup table, sse42 handles sets made of at most
+	 * eight contiguous value ranges, and scalar handles everything one table lookup at a time.
+	 * avx512vbmi2 classifies like avx2 but compacts with vpcompressb.
+	 */
+	enum class byte_kernel { scalar, sse42, avx2, avx512vbmi2 };
+
+	// The fastest kernel this CPU supports, detected once
+	[[nodiscard]] auto best_byte_kernel() noexcept -> byte_kernel;
+
+	// Whether this CPU can run kernel
+	[[nodiscard]] auto supports(byte_kernel kernel) noexcept -> bool;
+
+	// Number of bytes in [first, first + count) that are members of set
+	[[nodiscard]] auto count_in_set(const char* first,
+	                                std::size_t count,
+	                                const byte_set& set,
+	                                byte_kernel kernel = best_byte_kernel()) noexcept -> std::size_t;
+
+	// Offset of the first byte in [first, first + count) that is a member of set, or count if none is
+	[[nodiscard]] auto find_in_set(const char* first,
+	                               std::size_t count,
+	                               const byte_set& set,
+	                               byte_kernel kernel = best_byte_kernel()) noexcept -> std::size_t;
+
+	/**
+	 * Offset of the first occurrence of [needle, needle + needle_count) in [first, first + count),
+	 * or count if there is none. An empty needle is found at offset 0.
+	 */
+	[[nodiscard]] auto find_substring(const char* first,
+	                                  std::size_t count,
+	                                  const char* needle,
+	                                  std::size_t needle_count,
+	                                  byte_kernel kernel = best_byte_kernel()) noexcept -> std::size_t;
+
+	/**
+	 * Copies the members of set in [first, first + count) to out, in order, stopping once
+	 * capacity bytes have been written. Never writes past out + capacity.
+	 *
+	 * @return The number of bytes written.
+	 */
+	auto compact_in_set(const char* first,
+	                    std::size_t count,
+	                    const byte_set& set,
+	                    char* out,
+	                    std::size_t capacity,
+	                    byte_kernel kernel = best_byte_kernel()) noexcept -> std::size_t;
+
+	/**
+	 * A 64-bit hash of a byte sequence that arrives in pieces. The value depends only on the
+	 * concatenated bytes and never on where they were split, so hashing a view's kept runs one
+	 * by one gives the same value as hashing the materialized string.
+	 *
+	 * Whole 64-byte stripes are folded into eight 64-bit lanes with one 32x32->64 multiply per
+	 * lane, two vectors per stripe with avx2, and the lanes are scrambled every 1 KiB. Anything
+	 * shorter than a stripe is mixed in by digest(), so short keys never touch the lanes.
+	 */
+	class hash_stream {
+	 public:
+		hash_stream() noexcept;
+
+		auto update(const char* first, std::size_t count, byte_kernel kernel = best_byte_kernel()) noexcept -> void;
+		[[nodiscard]] auto digest() const noexcept -> std::uint64_t;
+
+	 private:
+		static constexpr auto stripe = std::size_t{64};
+
+		std::array<std::uint64_t, 8> lanes_;
+		std::uint64_t stripes_;
+		std::array<char, stripe> pending_;
+		std::size_t pending_size_;
+	};
+
+	// hash_stream's digest of [first, first + count) fed in one piece
+	[[nodiscard]] auto hash_bytes(const char* first,
+	                              std::size_t count,
+	                              byte_kernel kernel = best_byte_kernel()) noexcept -> std::uint64_t;
+} // namespace fsv::detail
+
+#endif // COMP6771_ASS2_BYTE_KERNELS_H
@@ -0,0 +1,169 @@
+#include "./byte_kernels.h"
+
+#include <algorithm>
+#include <catch2/catch.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+	auto make_set(const std::string& members) -> fsv::byte_set {
+		auto set = fsv::byte_set{};
+		for (const auto c : members) {
+			set.insert(c);
+		}
+		return set;
+	}
+
+	auto make_buffer(std::size_t size) -> std::string {
+		auto buffer = std::string(size, '\0');
+		auto state = std::uint32_t{12345};
+		for (auto& c : buffer) {
+			state = state * 1103515245U + 12345U;
+			c = static_cast<char>(state >> 16U);
+		}
+		return buffer;
+	}
+
+	auto all_kernels() -> std::vector<fsv::detail::byte_kernel> {
+		auto kernels = std::vector<fsv::detail::byte_kernel>{};
+		for (const auto kernel :
+		     {fsv::detail::byte_kernel::scalar,
+		      fsv::detail::byte_kernel::sse42,
+		      fsv::detail::byte_kernel::avx2,
+		      fsv::detail::byte_kernel::avx512vbmi2})
+		{
+			if (fsv::detail::supports(kernel)) {
+				kernels.push_back(kernel);
+			}
+		}
+		return kernels;
+	}
+
+	auto test_sets() -> std::vector<fsv::byte_set> {
+		auto high = fsv::byte_set{};
+		for (auto value = 0x80; value < 0x100; ++value) {
+			high.insert(static_cast<char>(value));
+		}
+		return {make_set("0123456789"),
+		        make_set("aeiouAEIOU"),
+		        make_set(std::string(1, '\0')),
+		        make_set("\x7f\x80\xff"),
+		        high,
+		        fsv::byte_set{},
+		        fsv::byte_set::all()};
+	}
+} // namespace
+
+TEST_CASE("Byte Kernels - scalar is always supported") {
+	CHECK(fsv::detail::supports(fsv::detail::byte_kernel::scalar));
+	CHECK(fsv::detail::supports(fsv::detail::best_byte_kernel()));
+}
+
+TEST_CASE("Byte Kernels - count_in_set matches a table loop") {
+	const auto buffer = make_buffer(1000);
+	for (const auto& set : test_sets()) {
+		for (const auto size : {std::size_t{0}, std::size_t{5}, std::size_t{31}, std::size_t{33}, std::size_t{999}}) {
+			auto expected = std::size_t{0};
+			for (auto i = std::size_t{0}; i < size; ++i) {
+				expected += static_cast<std::size_t>(set.contains(buffer[i + 1]));
+			}
+			for (const auto kernel : all_kernels()) {
+				CHECK(fsv::detail::count_in_set(buffer.data() + 1, size, set, kernel) == expected);
+			}
+		}
+	}
+}
+
+TEST_CASE("Byte Kernels - find_in_set stops at the first member") {
+	auto buffer = std::string(300, 'x');
+	const auto set = make_set("0123456789");
+	for (const auto kernel : all_kernels()) {
+		CHECK(fsv::detail::find_in_set(buffer.data(), buffer.size(), set, kernel) == buffer.size());
+	}
+	for (const auto position : {std::size_t{0}, std::size_t{17}, std::size_t{40}, std::size_t{299}}) {
+		buffer.assign(300, 'x');
+		buffer[position] = '7';
+		buffer[299] = '1';
+		for (const auto kernel : all_kernels()) {
+			CHECK(fsv::detail::find_in_set(buffer.data(), buffer.size(), set, kernel) == position);
+		}
+	}
+}
+
+TEST_CASE("Byte Kernels - find_substring matches std::search") {
+	auto haystack = std::string(500, 'a');
+	haystack[100] = 'b';
+	haystack.replace(250, 5, "abcab");
+	haystack.replace(490, 5, "xyzab");
+	const auto needles = std::vector<std::string>{"", "b", "ab", "abca", "abcab", "xyzab", "zz", std::string(40, 'a'),
+	                                              std::string(501, 'a')};
+	for (const auto& needle : needles) {
+		for (const auto count : {std::size_t{0}, std::size_t{3}, std::size_t{31}, std::size_t{252}, std::size_t{500}}) {
+			const auto expected = static_cast<std::size_t>(
+			    std::search(haystack.data(), haystack.data() + count, needle.data(), needle.data() + needle.size())
+			    - haystack.data());
+			for (const auto kernel : all_kernels()) {
+				CHECK(fsv::detail::find_substring(haystack.data(), count, needle.data(), needle.size(), kernel)
+				      == expected);
+			}
+		}
+	}
+}
+
+TEST_CASE("Byte Kernels - compact_in_set packs members in order within capacity") {
+	const auto buffer = make_buffer(700);
+	for (const auto& set : test_sets()) {
+		auto expected = std::string{};
+		for (const auto c : buffer) {
+			if (set.contains(c)) {
+				expected.push_back(c);
+			}
+		}
+		for (const auto kernel : all_kernels()) {
+			for (const auto cap : {expected.size(), expected.size() / 2, std::size_t{3}}) {
+				auto out = std::string(cap + 32, '#');
+				const auto written = fsv::detail::compact_in_set(buffer.data(), buffer.size(), set, out.data(), cap, kernel);
+				CHECK(written == std::min(cap, expected.size()));
+				CHECK(out.substr(0, written) == expected.substr(0, written));
+				CHECK(out.substr(cap) == std::string(32, '#'));
+			}
+		}
+	}
+	for (const auto kernel : all_kernels()) {
+		CHECK(fsv::detail::compact_in_set(nullptr, 0, fsv::byte_set::all(), nullptr, 0, kernel) == 0);
+	}
+}
+
+TEST_CASE("Byte Kernels - hash_stream ignores how the input is split") {
+	const auto buffer = make_buffer(3000);
+	for (const auto size : {std::size_t{0}, std::size_t{3}, std::size_t{17}, std::size_t{64}, std::size_t{1100}, buffer.size()}) {
+		const auto whole = fsv::detail::hash_bytes(buffer.data(), size, fsv::detail::byte_kernel::scalar);
+		for (const auto kernel : all_kernels()) {
+			CHECK(fsv::detail::hash_bytes(buffer.data(), size, kernel) == whole);
+			for (const auto piece : {std::size_t{1}, std::size_t{7}, std::size_t{63}, std::size_t{65}, std::size_t{500}}) {
+				auto stream = fsv::detail::hash_stream{};
+				for (auto offset = std::size_t{0}; offset < size; offset += piece) {
+					stream.update(buffer.data() + offset, std::min(piece, size - offset), kernel);
+				}
+				CHECK(stream.digest() == whole);
+			}
+		}
+	}
+}
+
+TEST_CASE("Byte Kernels - hash_bytes separates prefixes and single bit flips") {
+	auto buffer = make_buffer(2100);
+	auto seen = std::vector<std::uint64_t>{};
+	for (auto size = std::size_t{0}; size <= buffer.size(); size += size < 130 ? 1 : 97) {
+		seen.push_back(fsv::detail::hash_bytes(buffer.data(), size));
+	}
+	for (const auto position : {std::size_t{0}, std::size_t{31}, std::size_t{64}, std::size_t{1500}, std::size_t{2099}}) {
+		for (auto bit = 0; bit < 8; ++bit) {
+			buffer[position] = static_cast<char>(buffer[position] ^ (1 << bit));
+			seen.push_back(fsv::detail::hash_bytes(buffer.data(), buffer.size()));
+			buffer[position] = static_cast<char>(buffer[position] ^ (1 << bit));
+		}
+	}
+	std::ranges::sort(seen);
+	CHECK(std::ranges::adjacent_find(seen) == seen.end());
+}
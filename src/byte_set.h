@@ -0,0 +1,74 @@
+#ifndef COMP6771_ASS2_BYTE_SET_H
+#define COMP6771_ASS2_BYTE_SET_H
+
+#include <array>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+
+namespace fsv {
+	/**
+	 * A 256-bit membership bitmap with one bit per char value.
+	 *
+	 * A predicate whose result depends only on the char value can be evaluated once for
+	 * every value and stored here, turning each later test into a table lookup.
+	 */
+	class byte_set {
+	 public:
+		constexpr byte_set() noexcept = default;
+
+		// Every char value is a member
+		[[nodiscard]] static constexpr auto all() noexcept -> byte_set {
+			auto set = byte_set{};
+			set.words_.fill(~std::uint64_t{0});
+			return set;
+		}
+
+		[[nodiscard]] constexpr auto contains(const char& c) const noexcept -> bool {
+			const auto value = static_cast<unsigned char>(c);
+			return ((words_[value >> 6U] >> (value & 63U)) & 1U) != 0;
+		}
+
+		constexpr auto insert(const char& c) noexcept -> void {
+			const auto value = static_cast<unsigned char>(c);
+			words_[value >> 6U] |= std::uint64_t{1} << (value & 63U);
+		}
+
+		// Number of member values
+		[[nodiscard]] constexpr auto count() const noexcept -> std::size_t {
+			auto result = std::size_t{0};
+			for (const auto word : words_) {
+				result += static_cast<std::size_t>(std::popcount(word));
+			}
+			return result;
+		}
+
+		[[nodiscard]] constexpr auto words() const noexcept -> const std::array<std::uint64_t, 4>& {
+			return words_;
+		}
+
+		friend constexpr auto operator&(const byte_set& lhs, const byte_set& rhs) noexcept -> byte_set {
+			auto set = byte_set{};
+			for (auto i = std::size_t{0}; i < set.words_.size(); ++i) {
+				set.words_[i] = lhs.words_[i] & rhs.words_[i];
+			}
+			return set;
+		}
+
+		// Every char value that is not a member of set
+		friend constexpr auto operator~(const byte_set& set) noexcept -> byte_set {
+			auto complement = byte_set{};
+			for (auto i = std::size_t{0}; i < set.words_.size(); ++i) {
+				complement.words_[i] = ~set.words_[i];
+			}
+			return complement;
+		}
+
+		friend constexpr auto operator==(const byte_set& lhs, const byte_set& rhs) noexcept -> bool = default;
+
+	 private:
+		std::array<std::uint64_t, 4> words_{};
+	};
+} // namespace fsv
+
+#endif // COMP6771_ASS2_BYTE_SET_H
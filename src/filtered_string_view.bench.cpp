@@ -0,0 +1,180 @@
+#include "./filtered_string_view.h"
+#include "./parallel.h"
+#include "./pattern_set.h"
+
+#include <catch2/catch.hpp>
+#include <chrono>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Benchmarks are hidden test cases; run them with `filtered_string_view_bench "[bench]"`.
+
+namespace {
+	// Best of several runs of fn, in microseconds
+	auto best_of(int runs, const std::function<void()>& fn) -> long long {
+		auto best = std::chrono::steady_clock::duration::max();
+		for (auto i = 0; i < runs; ++i) {
+			const auto start = std::chrono::steady_clock::now();
+			fn();
+			best = std::min(best, std::chrono::steady_clock::now() - start);
+		}
+		return std::chrono::duration_cast<std::chrono::microseconds>(best).count();
+	}
+
+	auto report(const std::string& name, long long microseconds) -> void {
+		std::cout << "  " << name << ": " << microseconds << " us\n";
+	}
+
+	// 16 MiB of log-like text with a few bytes to drop in every line
+	auto make_payload() -> std::string {
+		auto payload = std::string{};
+		for (auto i = 0; payload.size() < (std::size_t{16} << 20U); ++i) {
+			payload += "2024-01-01T00:00:00Z\tINFO\trequest=" + std::to_string(i) + "\tstatus=200\r\n";
+		}
+		return payload;
+	}
+
+	auto write_all(int fd, const std::string& bytes) -> void {
+		auto written = std::size_t{0};
+		while (written < bytes.size()) {
+			const auto result = ::write(fd, bytes.data() + written, bytes.size() - written);
+			if (result < 0) {
+				return;
+			}
+			written += static_cast<std::size_t>(result);
+		}
+	}
+
+	// Runs fn with the write end of a pipe while another thread drains the read end
+	auto with_drained_pipe(const std::function<void(int)>& fn) -> void {
+		int ends[2];
+		REQUIRE(::pipe(ends) == 0);
+		auto drain = std::thread{[read_end = ends[0]] {
+			auto sink = std::string(1 << 16, '\0');
+			while (::read(read_end, sink.data(), sink.size()) > 0) {
+			}
+		}};
+		fn(ends[1]);
+		::close(ends[1]);
+		drain.join();
+		::close(ends[0]);
+	}
+
+	auto bench_write_to_fd(const fsv::filtered_string_view& sv) -> void {
+		constexpr auto runs = 5;
+		std::cout << "write " << sv.size() << " kept bytes in " << std::ranges::distance(sv.chunks())
+		          << " runs to a pipe\n";
+		report("materialize + write", best_of(runs, [&] {
+			       with_drained_pipe([&](int fd) { write_all(fd, static_cast<std::string>(sv)); });
+		       }));
+		report("write_to_fd", best_of(runs, [&] {
+			       with_drained_pipe([&](int fd) { fsv::write_to_fd(fd, sv); });
+		       }));
+
+		// /dev/shm is tmpfs on Linux, so this measures the copy into the page cache and not a disk.
+		auto* file = std::fopen("/dev/shm/filtered_string_view.bench", "w+");
+		if (file == nullptr) {
+			WARN("no tmpfs at /dev/shm");
+			return;
+		}
+		const auto fd = ::fileno(file);
+		std::cout << "same to a tmpfs file\n";
+		report("materialize + write", best_of(runs, [&] {
+			       REQUIRE(::ftruncate(fd, 0) == 0);
+			       REQUIRE(::lseek(fd, 0, SEEK_SET) == 0);
+			       write_all(fd, static_cast<std::string>(sv));
+		       }));
+		report("write_to_fd", best_of(runs, [&] {
+			       REQUIRE(::ftruncate(fd, 0) == 0);
+			       REQUIRE(::lseek(fd, 0, SEEK_SET) == 0);
+			       fsv::write_to_fd(fd, sv);
+		       }));
+		std::fclose(file);
+		std::remove("/dev/shm/filtered_string_view.bench");
+	}
+} // namespace
+
+TEST_CASE("Bench - write_to_fd against materialize then write", "[.][bench]") {
+	auto payload = make_payload();
+
+	// Short runs: every line loses its '\r', so each iovec carries only about 80 bytes.
+	bench_write_to_fd(fsv::filtered_string_view{payload, fsv::pure_filter{[](const char& c) { return c != '\r'; }}});
+
+	// Long runs: one dropped byte every 64 KiB.
+	for (auto i = std::size_t{0}; i < payload.size(); i += std::size_t{1} << 16U) {
+		payload[i] = '\0';
+	}
+	bench_write_to_fd(fsv::filtered_string_view{payload, fsv::pure_filter{[](const char& c) { return c != '\0'; }}});
+}
+
+TEST_CASE("Bench - parallel size scaling", "[.][bench]") {
+	auto text = std::string(std::size_t{256} << 20U, 'x');
+	for (auto i = std::size_t{0}; i < text.size(); i += 7) {
+		text[i] = 'y';
+	}
+	const auto opaque = fsv::filtered_string_view{text, [](const char& c) { return c == 'y'; }};
+	const auto compiled = fsv::filtered_string_view{text, fsv::pure_filter{[](const char& c) { return c == 'y'; }}};
+	const auto expected = compiled.size();
+	constexpr auto runs = 3;
+
+	std::cout << "parallel::size over " << text.size() << " raw bytes, " << std::thread::hardware_concurrency()
+	          << " hardware threads\n";
+	for (const auto threads : {1, 2, 4, 8, 16, 32}) {
+		const auto opts = fsv::parallel::options{.threshold = 0, .threads = static_cast<std::size_t>(threads)};
+		report(std::to_string(threads) + " threads, opaque predicate",
+		       best_of(runs, [&] { REQUIRE(fsv::parallel::size(opaque, opts) == expected); }));
+		report(std::to_string(threads) + " threads, compiled predicate",
+		       best_of(runs, [&] { REQUIRE(fsv::parallel::size(compiled, opts) == expected); }));
+		report(std::to_string(threads) + " threads, materialize",
+		       best_of(runs, [&] { REQUIRE(fsv::parallel::materialize(compiled, opts).size() == expected); }));
+	}
+}
+
+TEST_CASE("Bench - pattern_set against find once per pattern", "[.][bench]") {
+	const auto payload = make_payload();
+	const auto no_cr = fsv::pure_filter{[](const char& c) { return c != '\r'; }};
+
+	// A thousand keywords: a few that occur in every line and many that never do.
+	auto keywords = std::vector<std::string>{"INFO", "status=200", "request=4242", "T00:00"};
+	auto state = std::uint32_t{6771};
+	while (keywords.size() < 1000) {
+		auto keyword = std::string{};
+		for (auto i = 0; i < 8; ++i) {
+			state = state * 1103515245U + 12345U;
+			keyword += static_cast<char>('a' + (state >> 16U) % 26U);
+		}
+		keywords.push_back(keyword);
+	}
+	const auto set = fsv::pattern_set{keywords};
+	constexpr auto runs = 3;
+
+	// Looping find is too slow for the whole payload, so both are also timed on its first MiB.
+	const auto slice = std::string{payload.substr(0, std::size_t{1} << 20U)};
+	const auto small = fsv::filtered_string_view{slice, no_cr};
+	auto expected = std::size_t{0};
+	std::cout << keywords.size() << " keywords, " << set.states() << " automaton states, over "
+	          << small.size() << " kept bytes\n";
+	report("find per keyword", best_of(1, [&] {
+		       expected = 0;
+		       for (const auto& keyword : keywords) {
+			       const auto needle = fsv::filtered_string_view{keyword};
+			       for (auto pos = small.find(needle); pos != fsv::filtered_string_view::npos;
+			            pos = small.find(needle, pos + 1))
+			       {
+				       ++expected;
+			       }
+		       }
+	       }));
+	report("pattern_set::count", best_of(runs, [&] { REQUIRE(set.count(small) == expected); }));
+
+	const auto whole = fsv::filtered_string_view{payload, no_cr};
+	std::cout << "pattern_set over " << whole.size() << " kept bytes\n";
+	auto total = std::size_t{0};
+	report("pattern_set::count", best_of(runs, [&] { total = set.count(whole); }));
+	report("pattern_set::find_all", best_of(runs, [&] { REQUIRE(set.find_all(whole).size() == total); }));
+}
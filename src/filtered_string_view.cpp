@@ -1,56 +1,615 @@
 #include "./filtered_string_view.h"
 
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <climits>
+#include <cstdint>
+#include <limits>
+#include <mutex>
+#include <numeric>
+#include <system_error>
+#include <tuple>
+
+#include <sys/uio.h>
+
+#include "./byte_kernels.h"
+
 // Static Data Members
 fsv::filter fsv::filtered_string_view::default_predicate = [](const char&) { return true; };
 
+// Rank/select index shared by every copy of a view, built on first use
+struct fsv::filtered_string_view::lazy_index {
+	std::once_flag once;
+	std::optional<detail::rank_select_index> index;
+	// Set once index is built, so callers can check for it without building it.
+	std::atomic<bool> built = false;
+};
+
+namespace {
+	// The table of every view that filters nothing out, for iterators to borrow
+	constexpr auto every_byte = fsv::byte_set::all();
+	// Iterators tell a borrowed table from a borrowed predicate by the low bit of its address.
+	static_assert(alignof(fsv::byte_set) > 1 and alignof(fsv::filter) > 1);
+
+	/**
+	 * The default predicate, shared without ownership, so that default views never allocate.
+	 */
+	auto shared_default_predicate() noexcept -> std::shared_ptr<const fsv::filter> {
+		return std::shared_ptr<const fsv::filter>{std::shared_ptr<const fsv::filter>{},
+		                                          &fsv::filtered_string_view::default_predicate};
+	}
+
+	/**
+	 * Calls fn with the cheapest callable that answers "is this char kept?": a lookup into
+	 * table when the predicate has been compiled, otherwise the predicate itself. Choosing
+	 * once per operation keeps the per-byte loops free of the std::function indirection.
+	 *
+	 * @param table The compiled byte_set of the predicate, if any.
+	 * @param predicate The predicate of the filtered_string_view.
+	 * @param fn A callable accepting the chosen `bool(const char&)` callable.
+	 * @return Whatever fn returns.
+	 */
+	template<typename Fn>
+	auto with_keep(const std::optional<fsv::byte_set>& table, const fsv::filter& predicate, Fn&& fn) -> decltype(auto) {
+		if (table.has_value()) {
+			const auto set = *table;
+			return fn([&set](const char& c) { return set.contains(c); });
+		}
+		return fn([&predicate](const char& c) { return predicate(c); });
+	}
+
+	/**
+	 * Orders two raw char ranges the way comparing them char by char would. memcmp skips
+	 * equal blocks, but orders bytes as unsigned, so the first difference is compared as char.
+	 */
+	auto compare_raw(const char* lhs, std::size_t lhs_size, const char* rhs, std::size_t rhs_size) noexcept
+	    -> std::strong_ordering {
+		constexpr auto block = std::size_t{64};
+		const auto common = std::min(lhs_size, rhs_size);
+		auto offset = std::size_t{0};
+		while (offset + block <= common and std::memcmp(lhs + offset, rhs + offset, block) == 0) {
+			offset += block;
+		}
+		for (; offset < common; ++offset) {
+			if (lhs[offset] != rhs[offset]) {
+				return lhs[offset] <=> rhs[offset];
+			}
+		}
+		return lhs_size <=> rhs_size;
+	}
+
+	/**
+	 * Hands out the kept chars of a raw range a block at a time. Each block of raw bytes is
+	 * compacted into a buffer, with the vector kernel when there is a table, and blocks that keep
+	 * nothing are skipped. A range that filters nothing out is handed out whole, without copying.
+	 */
+	class kept_blocks {
+	 public:
+		kept_blocks(const char* first,
+		            const char* last,
+		            bool identity,
+		            const std::optional<fsv::byte_set>& table,
+		            const fsv::filter& predicate) noexcept
+		: next_{first}
+		, last_{last}
+		, identity_{identity}
+		, table_{table}
+		, predicate_{predicate} {}
+
+		// Raw bytes compacted at a time
+		static constexpr auto block = std::size_t{2048};
+
+		// The next kept chars, which stay valid until the next call, or an empty span at the end
+		auto next() -> std::span<const char> {
+			raw_first_ = next_;
+			if (identity_) {
+				return {std::exchange(next_, last_), last_};
+			}
+			while (next_ != last_) {
+				const auto count = std::min(block, static_cast<std::size_t>(last_ - next_));
+				const auto* raw = std::exchange(next_, next_ + count);
+				raw_first_ = raw;
+				const auto kept = table_.has_value()
+				                      ? fsv::detail::compact_in_set(raw, count, *table_, buffer_.data(), count)
+				                      : static_cast<std::size_t>(
+				                          std::copy_if(raw, raw + count, buffer_.data(), std::cref(predicate_))
+				                          - buffer_.data());
+				if (kept != 0) {
+					return {buffer_.data(), kept};
+				}
+			}
+			return {};
+		}
+
+		// The raw byte the span last returned by next() starts at or after
+		[[nodiscard]] auto raw_first() const noexcept -> const char* {
+			return raw_first_;
+		}
+
+	 private:
+		const char* next_;
+		const char* raw_first_ = nullptr;
+		const char* last_;
+		bool identity_;
+		const std::optional<fsv::byte_set>& table_;
+		const fsv::filter& predicate_;
+		std::array<char, block> buffer_;
+	};
+
+	/**
+	 * Offset of the last occurrence of [needle, needle + needle_count) in [first, first + count),
+	 * or count if there is none. Candidates are found with memrchr on the needle's last byte.
+	 */
+	auto rfind_substring(const char* first, std::size_t count, const char* needle, std::size_t needle_count) noexcept
+	    -> std::size_t {
+		if (needle_count == 0 or needle_count > count) {
+			return count;
+		}
+		const auto* lowest_end = first + needle_count - 1;
+		auto end = first + count;
+		while (end != lowest_end) {
+			const auto* candidate = static_cast<const char*>(
+			    ::memrchr(lowest_end, needle[needle_count - 1], static_cast<std::size_t>(end - lowest_end)));
+			if (candidate == nullptr) {
+				break;
+			}
+			const auto* start = candidate - (needle_count - 1);
+			if (std::memcmp(start, needle, needle_count - 1) == 0) {
+				return static_cast<std::size_t>(start - first);
+			}
+			end = candidate;
+		}
+		return count;
+	}
+
+	/**
+	 * Orders the kept chars of lhs against those of rhs. Blocks from both sides are lined up and
+	 * compared with memcmp, and only the pair that differs is compared again char by char.
+	 */
+	auto compare_blocks(kept_blocks& lhs, kept_blocks& rhs) -> std::strong_ordering {
+		auto lhs_block = lhs.next();
+		auto rhs_block = rhs.next();
+		while (not lhs_block.empty() and not rhs_block.empty()) {
+			const auto common = std::min(lhs_block.size(), rhs_block.size());
+			if (std::memcmp(lhs_block.data(), rhs_block.data(), common) != 0) {
+				return compare_raw(lhs_block.data(), common, rhs_block.data(), common);
+			}
+			lhs_block = lhs_block.size() == common ? lhs.next() : lhs_block.subspan(common);
+			rhs_block = rhs_block.size() == common ? rhs.next() : rhs_block.subspan(common);
+		}
+		return not lhs_block.empty() <=> not rhs_block.empty();
+	}
+
+	/**
+	 * The first member of set in [first, last), or last. Short distances are common between run
+	 * edges, so a few bytes are probed directly before paying for the vector kernel's set-up.
+	 */
+	auto find_member(const char* first, const char* last, const fsv::byte_set& set) noexcept -> const char* {
+		constexpr auto probe = std::ptrdiff_t{64};
+		const auto* probe_last = last - first > probe ? first + probe : last;
+		const auto* found = std::find_if(first, probe_last, [&set](const char& c) { return set.contains(c); });
+		if (found != probe_last or probe_last == last) {
+			return found;
+		}
+		return probe_last
+		       + fsv::detail::find_in_set(probe_last, static_cast<std::size_t>(last - probe_last), set);
+	}
+
+	/**
+	 * Streams over the kept bytes of [from, last) looking for the kept bytes of
+	 * [tok_first, tok_last), without gathering either side into a buffer.
+	 *
+	 * @return The raw range from the first matched byte to one past the last matched byte,
+	 *         or {last, last} if tok's kept bytes do not occur.
+	 */
+	template<typename Keep, typename TokKeep>
+	auto find_filtered(const char* from,
+	                   const char* last,
+	                   const Keep& keep,
+	                   const char* tok_first,
+	                   const char* tok_last,
+	                   const TokKeep& tok_keep) -> std::pair<const char*, const char*> {
+		const auto* tok_head = std::find_if(tok_first, tok_last, tok_keep);
+		for (const auto* candidate = from; candidate != last; ++candidate) {
+			if (*candidate != *tok_head or not keep(*candidate)) {
+				continue;
+			}
+			const auto* hay = candidate + 1;
+			const auto* needle = std::find_if(tok_head + 1, tok_last, tok_keep);
+			while (needle != tok_last) {
+				hay = std::find_if(hay, last, keep);
+				if (hay == last or *hay != *needle) {
+					break;
+				}
+				++hay;
+				needle = std::find_if(needle + 1, tok_last, tok_keep);
+			}
+			if (needle == tok_last) {
+				return {candidate, hay};
+			}
+		}
+		return {last, last};
+	}
+
+	/**
+	 * Folds every pure predicate, fsv's included, into one table and keeps the rest in call order,
+	 * with the filters of an already composed predicate spliced in rather than nested.
+	 */
+	auto flatten(const fsv::filtered_string_view& fsv, const std::vector<fsv::filter>& filts)
+	    -> std::pair<fsv::byte_set, std::vector<fsv::filter>> {
+		auto table = fsv::byte_set::all();
+		auto opaque = std::vector<fsv::filter>{};
+		auto absorb = [&table, &opaque](const fsv::filter& filt) {
+			if (const auto* pure = filt.target<fsv::pure_filter>(); pure != nullptr) {
+				table = table & pure->table();
+			}
+			else if (const auto* composed = filt.target<fsv::composed_filter>(); composed != nullptr) {
+				table = table & composed->table();
+				opaque.insert(opaque.end(), composed->filters().begin(), composed->filters().end());
+			}
+			else {
+				opaque.push_back(filt);
+			}
+		};
+		if (fsv.table().has_value()) {
+			table = *fsv.table();
+		}
+		else {
+			absorb(fsv.predicate());
+		}
+		std::ranges::for_each(filts, absorb);
+		return {table, std::move(opaque)};
+	}
+} // namespace
+
+// Pure Filter - Predicate Constructor
+fsv::pure_filter::pure_filter(const filter& predicate)
+: table_{} {
+	for (auto value = 0; value < 256; ++value) {
+		const auto c = static_cast<char>(value);
+		if (predicate(c)) {
+			table_.insert(c);
+		}
+	}
+}
+
+// Pure Filter - Table Constructor
+fsv::pure_filter::pure_filter(const byte_set& table) noexcept
+: table_{table} {}
+
+// Pure Filter - Call Operator
+auto fsv::pure_filter::operator()(const char& c) const noexcept -> bool {
+	return table_.contains(c);
+}
+
+// Pure Filter - table
+auto fsv::pure_filter::table() const noexcept -> const byte_set& {
+	return table_;
+}
+
+// Measurements and current order of an adaptive composed_filter, shared by all of its copies
+struct fsv::composed_filter::adaptive_state {
+	adaptive_state(std::size_t filters, const adaptive_options& options);
+
+	// Tells apart the adaptive filters a thread is counting calls to.
+	const std::uint64_t id;
+	const adaptive_options opts;
+	// Read on every call without locking. Points into orders, which only ever grows, so an order
+	// a caller is still walking is never freed under it.
+	std::atomic<const std::vector<std::size_t>*> order;
+
+	std::mutex mutex;
+	// Guarded by mutex.
+	std::vector<std::unique_ptr<const std::vector<std::size_t>>> orders;
+	std::vector<filter_stats> measured;
+	std::size_t reorders;
+
+	auto measure(const std::vector<filter>& filters, const std::string& sampled) -> void;
+};
+
+namespace {
+	auto next_adaptive_id = std::atomic<std::uint64_t>{1};
+
+	// How far one thread is through the sampling period of one adaptive filter
+	struct adaptive_tick {
+		std::uint64_t owner = 0;
+		std::size_t calls = 0;
+		std::string sampled;
+	};
+
+	// The adaptive filters this thread has called most recently. A thread seldom uses more than
+	// one or two at a time, so they are searched in order and evicted in turn.
+	thread_local auto adaptive_ticks = std::array<adaptive_tick, 8>{};
+	thread_local auto adaptive_evict = std::size_t{0};
+
+	auto tick_for(std::uint64_t owner) -> adaptive_tick& {
+		for (auto& tick : adaptive_ticks) {
+			if (tick.owner == owner) {
+				return tick;
+			}
+		}
+		auto& tick = adaptive_ticks[adaptive_evict++ % adaptive_ticks.size()];
+		tick.owner = owner;
+		tick.calls = 0;
+		tick.sampled.clear();
+		return tick;
+	}
+} // namespace
+
+// Adaptive State - Constructor
+fsv::composed_filter::adaptive_state::adaptive_state(std::size_t filters, const adaptive_options& options)
+: id{next_adaptive_id.fetch_add(1, std::memory_order_relaxed)}
+, opts{std::max(options.sample, std::size_t{1}), std::max({options.period, options.sample, std::size_t{1}})}
+, order{nullptr}
+, measured(filters, filter_stats{0, 0, std::chrono::nanoseconds{0}})
+, reorders{0} {
+	auto identity = std::vector<std::size_t>(filters);
+	std::iota(identity.begin(), identity.end(), std::size_t{0});
+	orders.push_back(std::make_unique<const std::vector<std::size_t>>(std::move(identity)));
+	order.store(orders.back().get(), std::memory_order_release);
+}
+
+// Adaptive State - measure
+auto fsv::composed_filter::adaptive_state::measure(const std::vector<filter>& filters, const std::string& sampled)
+    -> void {
+	// Every filter runs over the whole sample as one timed batch, so the clock is read twice per
+	// filter rather than per call, and a rejection rate does not depend on the filters before it.
+	auto batch = std::vector<filter_stats>{};
+	batch.reserve(filters.size());
+	for (const auto& filt : filters) {
+		const auto start = std::chrono::steady_clock::now();
+		const auto kept = static_cast<std::size_t>(std::ranges::count_if(sampled, std::cref(filt)));
+		batch.push_back({sampled.size(), sampled.size() - kept, std::chrono::steady_clock::now() - start});
+	}
+
+	// Another thread finishing its sample at the same time is already reordering, so this sample
+	// is dropped rather than waited on.
+	auto lock = std::unique_lock{mutex, std::try_to_lock};
+	if (not lock.owns_lock()) {
+		return;
+	}
+
+	// A filter's cost per char, divided by its chance of ending the chain, is its time per
+	// rejection. Only this sample counts, so the order follows the input. A filter that rejected
+	// nothing goes last.
+	constexpr auto never = std::numeric_limits<double>::infinity();
+	auto score = std::vector<double>(batch.size(), never);
+	for (auto i = std::size_t{0}; i < batch.size(); ++i) {
+		if (batch[i].rejections != 0) {
+			score[i] = static_cast<double>(batch[i].time.count()) / static_cast<double>(batch[i].rejections);
+		}
+		measured[i].calls += batch[i].calls;
+		measured[i].rejections += batch[i].rejections;
+		measured[i].time += batch[i].time;
+	}
+
+	const auto& current = *order.load(std::memory_order_relaxed);
+	auto next = current;
+	std::ranges::stable_sort(next, {}, [&score](std::size_t i) { return score[i]; });
+	if (next == current) {
+		return;
+	}
+	auto seen = std::ranges::find_if(orders, [&next](const auto& known) { return *known == next; });
+	if (seen == orders.end()) {
+		orders.push_back(std::make_unique<const std::vector<std::size_t>>(std::move(next)));
+		seen = std::prev(orders.end());
+	}
+	order.store(seen->get(), std::memory_order_release);
+	++reorders;
+}
+
+// Composed Filter - Constructor
+fsv::composed_filter::composed_filter(const byte_set& table, std::vector<filter> filters) noexcept
+: table_{table}
+, filters_{std::move(filters)}
+, adaptive_{nullptr} {}
+
+// Composed Filter - Adaptive Constructor
+fsv::composed_filter::composed_filter(const byte_set& table, std::vector<filter> filters, const adaptive_options& opts)
+: table_{table}
+, filters_{std::move(filters)}
+, adaptive_{std::make_shared<adaptive_state>(filters_.size(), opts)} {}
+
+// Composed Filter - Call Operator
+auto fsv::composed_filter::operator()(const char& c) const -> bool {
+	if (not table_.contains(c)) {
+		return false;
+	}
+	if (adaptive_ != nullptr) {
+		return call_adaptive(c);
+	}
+	return std::ranges::all_of(filters_, [&c](const filter& filt) { return filt(c); });
+}
+
+// Composed Filter - table
+auto fsv::composed_filter::table() const noexcept -> const byte_set& {
+	return table_;
+}
+
+// Composed Filter - filters
+auto fsv::composed_filter::filters() const noexcept -> const std::vector<filter>& {
+	return filters_;
+}
+
+// Composed Filter - stats
+auto fsv::composed_filter::stats() const -> std::optional<compose_stats> {
+	if (adaptive_ == nullptr) {
+		return std::nullopt;
+	}
+	const auto lock = std::scoped_lock{adaptive_->mutex};
+	return compose_stats{*adaptive_->order.load(std::memory_order_relaxed), adaptive_->measured, adaptive_->reorders};
+}
+
+// helper function - call_adaptive
+auto fsv::composed_filter::call_adaptive(const char& c) const -> bool {
+	auto& state = *adaptive_;
+	const auto& order = *state.order.load(std::memory_order_acquire);
+	const auto kept = std::ranges::all_of(order, [this, &c](std::size_t i) { return filters_[i](c); });
+
+	// Looked up after the filters run, in case one of them is itself adaptive and takes this slot.
+	auto& tick = tick_for(state.id);
+	const auto phase = tick.calls++ % state.opts.period;
+	if (phase < state.opts.sample) {
+		if (tick.sampled.empty()) {
+			tick.sampled.reserve(state.opts.sample);
+		}
+		tick.sampled.push_back(c);
+		if (phase == state.opts.sample - 1) {
+			const auto sampled = std::exchange(tick.sampled, std::string{});
+			state.measure(filters_, sampled);
+		}
+	}
+	return kept;
+}
+
 // Default Constructor
 fsv::filtered_string_view::filtered_string_view() noexcept
 : data_{nullptr}
 , size_{0}
-, predicate_{default_predicate} {};
+, first_{data_}
+, last_{data_ + size_}
+, predicate_{shared_default_predicate()}
+, table_{byte_set::all()}
+, identity_{true} {};
 
 // Implicit String Constructor
 fsv::filtered_string_view::filtered_string_view(const std::string& str) noexcept
 : data_{str.data()}
 , size_{str.size()}
-, predicate_{default_predicate} {};
+, first_{data_}
+, last_{data_ + size_}
+, predicate_{shared_default_predicate()}
+, table_{byte_set::all()}
+, identity_{true} {};
 
 // String Constructor with Predicate
 fsv::filtered_string_view::filtered_string_view(const std::string& str, filter predicate) noexcept
 : data_{str.data()}
 , size_{str.size()}
-, predicate_{std::move(predicate)} {};
+, first_{data_}
+, last_{data_ + size_}
+, predicate_{std::make_shared<const filter>(std::move(predicate))}
+, table_{std::nullopt}
+, identity_{false} {};
+
+// String Constructor with Pure Predicate
+fsv::filtered_string_view::filtered_string_view(const std::string& str, pure_filter predicate) noexcept
+: data_{str.data()}
+, size_{str.size()}
+, first_{data_}
+, last_{data_ + size_}
+, predicate_{std::make_shared<const filter>(predicate)}
+, table_{predicate.table()}
+, identity_{predicate.table() == byte_set::all()} {};
 
 // Implicit Null-Terminated String Constructor
 fsv::filtered_string_view::filtered_string_view(const char* str) noexcept
 : data_{str}
 , size_{std::strlen(str)}
-, predicate_{default_predicate} {};
+, first_{data_}
+, last_{data_ + size_}
+, predicate_{shared_default_predicate()}
+, table_{byte_set::all()}
+, identity_{true} {};
 
 // Null-Terminated String with Predicate Constructor
 fsv::filtered_string_view::filtered_string_view(const char* str, filter predicate) noexcept
 : data_{str}
 , size_{std::strlen(str)}
-, predicate_{predicate} {};
+, first_{data_}
+, last_{data_ + size_}
+, predicate_{std::make_shared<const filter>(predicate)}
+, table_{std::nullopt}
+, identity_{false} {};
+
+// Null-Terminated String with Pure Predicate Constructor
+fsv::filtered_string_view::filtered_string_view(const char* str, pure_filter predicate) noexcept
+: data_{str}
+, size_{std::strlen(str)}
+, first_{data_}
+, last_{data_ + size_}
+, predicate_{std::make_shared<const filter>(predicate)}
+, table_{predicate.table()}
+, identity_{predicate.table() == byte_set::all()} {};
+
+// Buffer Constructor
+fsv::filtered_string_view::filtered_string_view(const char* str, std::size_t size) noexcept
+: data_{str}
+, size_{size}
+, first_{data_}
+, last_{data_ + size_}
+, predicate_{shared_default_predicate()}
+, table_{byte_set::all()}
+, identity_{true} {};
+
+// Buffer with Predicate Constructor
+fsv::filtered_string_view::filtered_string_view(const char* str, std::size_t size, filter predicate) noexcept
+: data_{str}
+, size_{size}
+, first_{data_}
+, last_{data_ + size_}
+, predicate_{std::make_shared<const filter>(std::move(predicate))}
+, table_{std::nullopt}
+, identity_{false} {};
+
+// Buffer with Pure Predicate Constructor
+fsv::filtered_string_view::filtered_string_view(const char* str, std::size_t size, pure_filter predicate) noexcept
+: data_{str}
+, size_{size}
+, first_{data_}
+, last_{data_ + size_}
+, predicate_{std::make_shared<const filter>(predicate)}
+, table_{predicate.table()}
+, identity_{predicate.table() == byte_set::all()} {};
 
 // Copy Constructor
 fsv::filtered_string_view::filtered_string_view(const filtered_string_view& other) noexcept
 : data_{other.data_}
 , size_{other.size_}
-, predicate_{other.predicate_} {};
+, first_{other.first_}
+, last_{other.last_}
+, predicate_{other.predicate_}
+, table_{other.table_}
+, identity_{other.identity_}
+, index_{other.index_} {};
 
 // Move Constructor
 fsv::filtered_string_view::filtered_string_view(filtered_string_view&& other) noexcept
 : data_{std::exchange(other.data_, nullptr)}
 , size_{std::exchange(other.size_, 0)}
-, predicate_{std::exchange(other.predicate_, default_predicate)} {};
+, first_{std::exchange(other.first_, nullptr)}
+, last_{std::exchange(other.last_, nullptr)}
+, predicate_{std::exchange(other.predicate_, shared_default_predicate())}
+, table_{std::exchange(other.table_, byte_set::all())}
+, identity_{std::exchange(other.identity_, true)}
+, index_{std::exchange(other.index_, nullptr)} {};
+
+// Bounded Constructor
+fsv::filtered_string_view::filtered_string_view(const filtered_string_view& parent,
+                                                const char* first,
+                                                const char* last) noexcept
+: data_{parent.data_}
+, size_{parent.size_}
+, first_{first}
+, last_{last}
+, predicate_{parent.predicate_}
+, table_{parent.table_}
+, identity_{parent.identity_}
+, index_{nullptr} {};
 
 // Member Operator - Copy Assignment
 auto fsv::filtered_string_view::operator=(const filtered_string_view& other) noexcept -> filtered_string_view& {
 	if (this != &other) {
 		this->data_ = other.data_;
 		this->size_ = other.size_;
+		this->first_ = other.first_;
+		this->last_ = other.last_;
 		this->predicate_ = other.predicate_;
+		this->table_ = other.table_;
+		this->identity_ = other.identity_;
+		this->index_ = other.index_;
 	}
 	return *this;
 }
@@ -60,73 +619,89 @@ auto fsv::filtered_string_view::operator=(filtered_string_view&& other) noexcept
 	if (this != &other) {
 		this->data_ = std::exchange(other.data_, nullptr);
 		this->size_ = std::exchange(other.size_, 0);
-		this->predicate_ = std::exchange(other.predicate_, default_predicate);
+		this->first_ = std::exchange(other.first_, nullptr);
+		this->last_ = std::exchange(other.last_, nullptr);
+		this->predicate_ = std::exchange(other.predicate_, shared_default_predicate());
+		this->table_ = std::exchange(other.table_, byte_set::all());
+		this->identity_ = std::exchange(other.identity_, true);
+		this->index_ = std::exchange(other.index_, nullptr);
 	}
 	return *this;
 }
 
 // Member Operator - Subscript
-auto fsv::filtered_string_view::operator[](int n) const noexcept -> const char& {
-	auto index = 0;
-	for (auto i = size_t{0}; i < size_; i++) {
-		if (predicate_(data_[i])) {
-			if (index == n) {
-				return data_[i];
-			}
-			++index;
-		}
-	}
-	return data_[size_];
+auto fsv::filtered_string_view::operator[](std::size_t n) const noexcept -> const char& {
+	const auto* found = kept_from(first_, n);
+	assert(found != last_ and "filtered_string_view::operator[]: index out of range");
+	return *found;
 }
 
 // Member Operator - String Type Conversion
 fsv::filtered_string_view::operator std::string() const noexcept {
-	auto filtered_string = std::string{};
-	for (auto i = size_t{0}; i < size_; ++i) {
-		if (predicate_(data_[i])) {
-			filtered_string.push_back(data_[i]);
-		}
+	if (identity_) {
+		return std::string(first_, raw_size());
+	}
+	if (table_.has_value()) {
+		// Size the string from a fast count pass, then compact straight into it.
+		auto filtered_string = std::string(detail::count_in_set(first_, raw_size(), *table_), '\0');
+		detail::compact_in_set(first_, raw_size(), *table_, filtered_string.data(), filtered_string.size());
+		return filtered_string;
 	}
+	auto filtered_string = std::string{};
+	std::copy_if(first_, last_, std::back_inserter(filtered_string), std::cref(*predicate_));
 	return filtered_string;
 }
 
 // Member Function - at
-auto fsv::filtered_string_view::at(int index) const -> const char& {
-	auto position = index;
-	for (auto i = size_t{0}; i < size_; ++i) {
-		if (predicate_(data_[i])) {
-			if (position == 0) {
-				return data_[i];
-			}
-			--position;
-		}
+auto fsv::filtered_string_view::at(std::size_t index) const -> const char& {
+	const auto* found = kept_from(first_, index);
+	if (found == last_) {
+		throw std::domain_error{"filtered_string_view::at(" + std::to_string(index) + "): invalid index"};
 	}
-	throw std::domain_error{"filtered_string_view::at(" + std::to_string(index) + "): invalid index"};
+	return *found;
 }
 
 // Member Function - size
 auto fsv::filtered_string_view::size() const noexcept -> std::size_t {
-	auto size_count = size_t{0};
-	for (auto i = size_t{0}; i < size_; ++i) {
-		if (predicate_(data_[i])) {
-			++size_count;
-		}
+	if (identity_) {
+		return raw_size();
 	}
-	return size_count;
+	if (const auto* rank_select = built_index(); rank_select != nullptr) {
+		return rank_select->kept();
+	}
+	if (table_.has_value()) {
+		return detail::count_in_set(first_, raw_size(), *table_);
+	}
+	return static_cast<std::size_t>(std::count_if(first_, last_, std::cref(*predicate_)));
 }
 
 // Member Function - empty
 auto fsv::filtered_string_view::empty() const noexcept -> bool {
-	auto size_count = size_t{0};
-	for (auto i = size_t{0}; i < size_; ++i) {
-		if (predicate_(data_[i])) {
-			++size_count;
-		}
+	if (identity_) {
+		return first_ == last_;
 	}
-	if (size_count == 0) {
-		return true;
+	if (const auto* rank_select = built_index(); rank_select != nullptr) {
+		return rank_select->kept() == 0;
+	}
+	// Both paths stop at the first kept byte.
+	if (table_.has_value()) {
+		return detail::find_in_set(first_, raw_size(), *table_) == raw_size();
 	}
-	return false;
+	return std::none_of(first_, last_, std::cref(*predicate_));
+}
+
+// Member Function - copy_to
+auto fsv::filtered_string_view::copy_to(char* out, std::size_t cap) const noexcept -> std::size_t {
+	if (table_.has_value()) {
+		return detail::compact_in_set(first_, raw_size(), *table_, out, cap);
+	}
+	auto copied = std::size_t{0};
+	for (const auto* it = first_; it != last_ and copied < cap; ++it) {
+		if ((*predicate_)(*it)) {
+			out[copied++] = *it;
+		}
+	}
+	return copied;
 }
 
 // Member Function - data
@@ -136,236 +711,728 @@ auto fsv::filtered_string_view::data() const noexcept -> const char* {
 
 // Member Function - predicate
 auto fsv::filtered_string_view::predicate() const noexcept -> const filter& {
-	return predicate_;
+	return *predicate_;
+}
+
+// Member Function - table
+auto fsv::filtered_string_view::table() const noexcept -> const std::optional<byte_set>& {
+	return table_;
+}
+
+// Member Function - enable_index
+auto fsv::filtered_string_view::enable_index() -> void {
+	if (index_ == nullptr) {
+		index_ = std::make_shared<lazy_index>();
+	}
+}
+
+// Member Function - index_stats
+auto fsv::filtered_string_view::index_stats() const -> std::optional<fsv::index_stats> {
+	if (const auto* rank_select = built_index(); rank_select != nullptr) {
+		return rank_select->stats();
+	}
+	return std::nullopt;
+}
+
+// Member Function - find
+auto fsv::filtered_string_view::find(char c, std::size_t pos) const noexcept -> std::size_t {
+	return locate(c, pos).index;
+}
+
+// Member Function - find
+auto fsv::filtered_string_view::find(const filtered_string_view& needle, std::size_t pos) const noexcept
+    -> std::size_t {
+	return locate(needle, pos).index;
+}
+
+// Member Function - rfind
+auto fsv::filtered_string_view::rfind(char c, std::size_t pos) const noexcept -> std::size_t {
+	return rlocate(c, pos).index;
+}
+
+// Member Function - rfind
+auto fsv::filtered_string_view::rfind(const filtered_string_view& needle, std::size_t pos) const noexcept
+    -> std::size_t {
+	return rlocate(needle, pos).index;
+}
+
+// Member Function - contains
+auto fsv::filtered_string_view::contains(char c) const noexcept -> bool {
+	return locate(c).index != npos;
+}
+
+// Member Function - contains
+auto fsv::filtered_string_view::contains(const filtered_string_view& needle) const noexcept -> bool {
+	return locate(needle).index != npos;
+}
+
+// Member Function - starts_with
+auto fsv::filtered_string_view::starts_with(char c) const noexcept -> bool {
+	const auto* front = kept_from(first_, 0);
+	return front != last_ and *front == c;
+}
+
+// Member Function - starts_with
+auto fsv::filtered_string_view::starts_with(const filtered_string_view& needle) const noexcept -> bool {
+	const auto prefix = static_cast<std::string>(needle);
+	if (prefix.empty()) {
+		// Also keeps a default view's null first_ away from memcmp.
+		return true;
+	}
+	if (identity_) {
+		return raw_size() >= prefix.size() and std::memcmp(first_, prefix.data(), prefix.size()) == 0;
+	}
+	return with_keep(table_, *predicate_, [this, &prefix](const auto& keep) {
+		auto matched = std::size_t{0};
+		for (const auto* it = first_; it != last_ and matched != prefix.size(); ++it) {
+			if (keep(*it)) {
+				if (*it != prefix[matched]) {
+					return false;
+				}
+				++matched;
+			}
+		}
+		return matched == prefix.size();
+	});
+}
+
+// Member Function - ends_with
+auto fsv::filtered_string_view::ends_with(char c) const noexcept -> bool {
+	if (identity_) {
+		return first_ != last_ and *(last_ - 1) == c;
+	}
+	return with_keep(table_, *predicate_, [this, c](const auto& keep) {
+		for (const auto* it = last_; it != first_;) {
+			--it;
+			if (keep(*it)) {
+				return *it == c;
+			}
+		}
+		return false;
+	});
+}
+
+// Member Function - ends_with
+auto fsv::filtered_string_view::ends_with(const filtered_string_view& needle) const noexcept -> bool {
+	const auto suffix = static_cast<std::string>(needle);
+	if (suffix.empty()) {
+		// Also keeps a default view's null first_ away from memcmp.
+		return true;
+	}
+	if (identity_) {
+		return raw_size() >= suffix.size() and std::memcmp(last_ - suffix.size(), suffix.data(), suffix.size()) == 0;
+	}
+	// Matches from the last raw byte backwards, so only the tail of the view is ever read.
+	return with_keep(table_, *predicate_, [this, &suffix](const auto& keep) {
+		auto left = suffix.size();
+		for (const auto* it = last_; it != first_ and left != 0;) {
+			--it;
+			if (keep(*it)) {
+				if (*it != suffix[left - 1]) {
+					return false;
+				}
+				--left;
+			}
+		}
+		return left == 0;
+	});
+}
+
+// Member Function - locate
+auto fsv::filtered_string_view::locate(char c, std::size_t pos) const noexcept -> position {
+	constexpr auto missing = position{npos, nullptr};
+	if (table_.has_value() and not table_->contains(c)) {
+		return missing;
+	}
+	const auto* start = kept_from(first_, pos);
+	return with_keep(table_, *predicate_, [this, c, pos, start, missing](const auto& keep) {
+		// memchr finds the candidates; only they are checked against the predicate.
+		for (const auto* from = start; from != last_;) {
+			const auto* candidate =
+			    static_cast<const char*>(std::memchr(from, c, static_cast<std::size_t>(last_ - from)));
+			if (candidate == nullptr) {
+				break;
+			}
+			if (keep(*candidate)) {
+				return position{pos + kept_between(start, candidate), candidate};
+			}
+			from = candidate + 1;
+		}
+		return missing;
+	});
+}
+
+// Member Function - locate
+auto fsv::filtered_string_view::locate(const filtered_string_view& needle, std::size_t pos) const noexcept
+    -> position {
+	constexpr auto missing = position{npos, nullptr};
+	const auto pattern = static_cast<std::string>(needle);
+	const auto* start = kept_from(first_, pos);
+	if (pattern.empty()) {
+		return pos <= size() ? position{pos, start} : missing;
+	}
+	if (identity_) {
+		const auto count = static_cast<std::size_t>(last_ - start);
+		const auto offset = detail::find_substring(start, count, pattern.data(), pattern.size());
+		return offset == count ? missing : position{pos + offset, start + offset};
+	}
+
+	// Each block of kept bytes is searched after the last pattern.size() - 1 kept bytes of the
+	// blocks before it, so a match spanning two blocks is still seen whole.
+	auto blocks = kept_blocks{start, last_, identity_, table_, *predicate_};
+	auto window = std::string{};
+	auto window_index = pos;
+	for (auto block = blocks.next(); not block.empty(); block = blocks.next()) {
+		const auto carried = window.size();
+		window.append(block.data(), block.size());
+		const auto offset = detail::find_substring(window.data(), window.size(), pattern.data(), pattern.size());
+		if (offset != window.size()) {
+			const auto index = window_index + offset;
+			const auto* raw =
+			    offset >= carried ? kept_from(blocks.raw_first(), offset - carried) : kept_from(start, index - pos);
+			return position{index, raw};
+		}
+		const auto kept = std::min(window.size(), pattern.size() - 1);
+		window_index += window.size() - kept;
+		window.erase(0, window.size() - kept);
+	}
+	return missing;
+}
+
+// Member Function - rlocate
+auto fsv::filtered_string_view::rlocate(char c, std::size_t pos) const noexcept -> position {
+	constexpr auto missing = position{npos, nullptr};
+	if (table_.has_value() and not table_->contains(c)) {
+		return missing;
+	}
+	// Without a pos, the scan starts at the last raw byte and never reads what comes before the match.
+	const auto* at_pos = pos == npos ? last_ : kept_from(first_, pos);
+	const auto* end = at_pos == last_ ? last_ : at_pos + 1;
+	return with_keep(table_, *predicate_, [this, c, end, missing](const auto& keep) {
+		for (const auto* before = end; before != first_;) {
+			const auto* candidate =
+			    static_cast<const char*>(::memrchr(first_, c, static_cast<std::size_t>(before - first_)));
+			if (candidate == nullptr) {
+				break;
+			}
+			if (keep(*candidate)) {
+				return position{kept_between(first_, candidate), candidate};
+			}
+			before = candidate;
+		}
+		return missing;
+	});
+}
+
+// Member Function - rlocate
+auto fsv::filtered_string_view::rlocate(const filtered_string_view& needle, std::size_t pos) const noexcept
+    -> position {
+	constexpr auto missing = position{npos, nullptr};
+	const auto pattern = static_cast<std::string>(needle);
+	if (pattern.empty()) {
+		const auto index = std::min(pos, size());
+		return position{index, kept_from(first_, index)};
+	}
+	// A match may start at pos at the latest, so it ends before kept char pos + pattern.size().
+	const auto* end = pos >= npos - pattern.size() ? last_ : kept_from(first_, pos + pattern.size());
+	if (identity_) {
+		const auto count = static_cast<std::size_t>(end - first_);
+		const auto offset = rfind_substring(first_, count, pattern.data(), pattern.size());
+		return offset == count ? missing : position{offset, first_ + offset};
+	}
+
+	// Raw blocks are compacted from the end backwards. Each is searched before the first
+	// pattern.size() - 1 kept bytes of the blocks after it, so a match spanning two is seen whole.
+	auto window = std::string{};
+	for (const auto* block_last = end; block_last != first_;) {
+		const auto* block_first =
+		    first_ + std::max(block_last - first_, static_cast<std::ptrdiff_t>(kept_blocks::block))
+		    - static_cast<std::ptrdiff_t>(kept_blocks::block);
+		auto blocks = kept_blocks{block_first, block_last, identity_, table_, *predicate_};
+		const auto block = blocks.next();
+		window.insert(0, block.data(), block.size());
+		const auto offset = rfind_substring(window.data(), window.size(), pattern.data(), pattern.size());
+		if (offset != window.size()) {
+			// A match starting in the carried bytes would have been found in the blocks after.
+			return position{kept_between(first_, block_first) + offset, kept_from(block_first, offset)};
+		}
+		window.resize(std::min(window.size(), pattern.size() - 1));
+		block_last = block_first;
+	}
+	return missing;
+}
+
+// helper function - raw_size
+auto fsv::filtered_string_view::raw_size() const noexcept -> std::size_t {
+	return static_cast<std::size_t>(last_ - first_);
+}
+
+// helper function - cached_size
+auto fsv::filtered_string_view::cached_size() const -> std::optional<std::size_t> {
+	if (identity_) {
+		return raw_size();
+	}
+	if (const auto* rank_select = built_index(); rank_select != nullptr) {
+		return rank_select->kept();
+	}
+	return std::nullopt;
+}
+
+// helper function - kept_between
+auto fsv::filtered_string_view::kept_between(const char* from, const char* to) const noexcept -> std::size_t {
+	if (identity_) {
+		return static_cast<std::size_t>(to - from);
+	}
+	if (const auto* rank_select = built_index(); rank_select != nullptr) {
+		return rank_select->rank(static_cast<std::size_t>(to - first_))
+		       - rank_select->rank(static_cast<std::size_t>(from - first_));
+	}
+	if (table_.has_value()) {
+		return detail::count_in_set(from, static_cast<std::size_t>(to - from), *table_);
+	}
+	return static_cast<std::size_t>(std::count_if(from, to, std::cref(*predicate_)));
+}
+
+// helper function - built_index
+auto fsv::filtered_string_view::built_index() const -> const detail::rank_select_index* {
+	if (index_ == nullptr) {
+		return nullptr;
+	}
+	std::call_once(index_->once, [this] {
+		index_->index.emplace(first_, raw_size(), *predicate_);
+		index_->built.store(true, std::memory_order_release);
+	});
+	return &*index_->index;
+}
+
+// helper function - ready_index
+auto fsv::filtered_string_view::ready_index() const noexcept -> const detail::rank_select_index* {
+	if (index_ == nullptr or not index_->built.load(std::memory_order_acquire)) {
+		return nullptr;
+	}
+	return &*index_->index;
+}
+
+// helper function - kept_from
+auto fsv::filtered_string_view::kept_from(const char* from, std::size_t n) const noexcept -> const char* {
+	if (const auto* rank_select = built_index(); rank_select != nullptr) {
+		return first_ + rank_select->select(rank_select->rank(static_cast<std::size_t>(from - first_)) + n);
+	}
+	const auto remaining_bytes = static_cast<std::size_t>(last_ - from);
+	if (identity_) {
+		return n < remaining_bytes ? from + n : last_;
+	}
+	if (table_.has_value()) {
+		// Skip whole blocks by their member count, then find the char within the block holding it.
+		constexpr auto block = std::size_t{4096};
+		auto remaining = n;
+		auto offset = std::size_t{0};
+		for (; offset + block <= remaining_bytes; offset += block) {
+			const auto kept = detail::count_in_set(from + offset, block, *table_);
+			if (kept > remaining) {
+				break;
+			}
+			remaining -= kept;
+		}
+		for (; offset < remaining_bytes; ++offset) {
+			if (table_->contains(from[offset])) {
+				if (remaining == 0) {
+					return from + offset;
+				}
+				--remaining;
+			}
+		}
+		return last_;
+	}
+	auto remaining = n;
+	for (const auto* it = from; it != last_; ++it) {
+		if ((*predicate_)(*it)) {
+			if (remaining == 0) {
+				return it;
+			}
+			--remaining;
+		}
+	}
+	return last_;
 }
 
 // Non-Member Operator - Equality Comparison
 auto fsv::operator==(const filtered_string_view& lhs, const filtered_string_view& rhs) noexcept -> bool {
-	return std::equal(lhs.cbegin(), lhs.cend(), rhs.cbegin(), rhs.cend());
+	if (lhs.identity_ and rhs.identity_) {
+		return lhs.raw_size() == rhs.raw_size()
+		       and (lhs.raw_size() == 0 or std::memcmp(lhs.first_, rhs.first_, lhs.raw_size()) == 0);
+	}
+	const auto lhs_size = lhs.cached_size();
+	const auto rhs_size = rhs.cached_size();
+	if (lhs_size.has_value() and rhs_size.has_value() and *lhs_size != *rhs_size) {
+		return false;
+	}
+	auto lhs_blocks = kept_blocks{lhs.first_, lhs.last_, lhs.identity_, lhs.table_, *lhs.predicate_};
+	auto rhs_blocks = kept_blocks{rhs.first_, rhs.last_, rhs.identity_, rhs.table_, *rhs.predicate_};
+	return std::is_eq(compare_blocks(lhs_blocks, rhs_blocks));
 }
 
 // Non-Member Operator - Relational Comparison
 auto fsv::operator<=>(const filtered_string_view& lhs, const filtered_string_view& rhs) noexcept -> std::strong_ordering {
-	return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+	if (lhs.identity_ and rhs.identity_) {
+		return compare_raw(lhs.first_, lhs.raw_size(), rhs.first_, rhs.raw_size());
+	}
+	auto lhs_blocks = kept_blocks{lhs.first_, lhs.last_, lhs.identity_, lhs.table_, *lhs.predicate_};
+	auto rhs_blocks = kept_blocks{rhs.first_, rhs.last_, rhs.identity_, rhs.table_, *rhs.predicate_};
+	return compare_blocks(lhs_blocks, rhs_blocks);
+}
+
+// Transparent Hash - filtered_string_view
+auto fsv::transparent_hash::operator()(const filtered_string_view& fsv) const noexcept -> std::size_t {
+	if (fsv.identity_) {
+		return static_cast<std::size_t>(detail::hash_bytes(fsv.first_, fsv.raw_size()));
+	}
+	auto stream = detail::hash_stream{};
+	auto blocks = kept_blocks{fsv.first_, fsv.last_, fsv.identity_, fsv.table_, *fsv.predicate_};
+	for (auto block = blocks.next(); not block.empty(); block = blocks.next()) {
+		stream.update(block.data(), block.size());
+	}
+	return static_cast<std::size_t>(stream.digest());
+}
+
+// Transparent Hash - std::string
+auto fsv::transparent_hash::operator()(const std::string& str) const noexcept -> std::size_t {
+	return static_cast<std::size_t>(detail::hash_bytes(str.data(), str.size()));
+}
+
+// Transparent Hash - Char Range
+auto fsv::transparent_hash::operator()(std::span<const char> chars) const noexcept -> std::size_t {
+	return static_cast<std::size_t>(detail::hash_bytes(chars.data(), chars.size()));
+}
+
+// Transparent Hash - Null-Terminated String
+auto fsv::transparent_hash::operator()(const char* str) const noexcept -> std::size_t {
+	return static_cast<std::size_t>(detail::hash_bytes(str, std::strlen(str)));
 }
 
 // Non-Member Operator - Output Stream
 auto fsv::operator<<(std::ostream& os, const filtered_string_view& fsv) noexcept -> std::ostream& {
-	for (auto char_ = fsv.cbegin(); char_ != fsv.cend(); ++char_) {
-		os << *char_;
+	if (fsv.identity_) {
+		return os.write(fsv.first_, static_cast<std::streamsize>(fsv.raw_size()));
+	}
+	for (const auto run : fsv.chunks()) {
+		os.write(run.data(), static_cast<std::streamsize>(run.size()));
 	}
 	return os;
 }
 
 // Non-Member Utility Function - Compose
 auto fsv::compose(const filtered_string_view& fsv, const std::vector<filter>& filts) noexcept -> filtered_string_view {
+	// The result is fsv's own bytes and bounds with a new predicate, so nothing is re-measured.
+	auto view = filtered_string_view{fsv, fsv.first_, fsv.last_};
 	if (filts.empty()) {
-		return filtered_string_view(fsv.data(), fsv.default_predicate);
+		return view;
 	}
+	auto [table, opaque] = flatten(fsv, filts);
+	view.adopt(table, std::move(opaque), std::nullopt);
+	return view;
+}
 
-	auto new_predicate = [filts](const char& c) {
-		for (const auto& filt : filts) {
-			if (not(filt(c))) {
-				return false;
-			}
-		}
-		return true;
-	};
-	return filtered_string_view{fsv.data(), new_predicate};
-};
+// Non-Member Utility Function - Adaptive Compose
+auto fsv::compose(const filtered_string_view& fsv, const std::vector<filter>& filts, const adaptive_options& opts)
+    -> filtered_string_view {
+	auto view = filtered_string_view{fsv, fsv.first_, fsv.last_};
+	if (filts.empty()) {
+		return view;
+	}
+	auto [table, opaque] = flatten(fsv, filts);
+	view.adopt(table, std::move(opaque), opts);
+	return view;
+}
 
-namespace {
-	/**
-	 * The lambda function works as follows:
-	 *
-	 * 1.It keeps track of a "current_index" which keeps track of the current index
-	 *   of the character being evaluated.
-	 *
-	 * 2.The function checks if the character satisfies the given filter
-	 *   and if the current index is within the specified range [start_pos, end_pos].
-	 *   If both conditions are true, the function returns true.
-	 *
-	 * 3.After evaluating the character, the function increments the
-	 *   "current_index" and checks if it has reached the end of the string. If
-	 *   it has, the "current_index" is reset to 0.
-	 *
-	 * 4.The function is mutable, which means that it can modify its captured variables.
-	 *
-	 * @param filt The filter function to be applied to each character.
-	 * @param size_fsv_data The size of the underlying string data.
-	 * @param start_index The starting position of the substring.
-	 * @param end_index The ending position of the substring.
-	 * @return A predicate to filter the substring.
-	 */
-	auto filter_split(const fsv::filter filt,
-	                  const std::size_t size_fsv_data,
-	                  const std::size_t start_index,
-	                  const std::size_t end_index) noexcept -> fsv::filter {
-		auto current_index = std::size_t{0};
-		return [filt, size_fsv_data, start_index, end_index, current_index](const char& c) mutable {
-			auto result = false;
-			if (end_index != std::string::npos) {
-				if (current_index >= start_index and current_index <= end_index) {
-					if (filt(c)) {
-						result = true;
-					}
-				}
-			}
-			++current_index;
-			if (current_index == size_fsv_data) {
-				current_index = 0;
-			}
-			return result;
-		};
+// helper function - adopt
+auto fsv::filtered_string_view::adopt(const byte_set& table,
+                                      std::vector<filter> opaque,
+                                      const std::optional<adaptive_options>& opts) -> void {
+	if (opaque.empty()) {
+		predicate_ = std::make_shared<const filter>(pure_filter{table});
+		table_ = table;
+		identity_ = table == byte_set::all();
+		return;
 	}
-	/**
-	 * The lambda function works as follows:
-	 *
-	 * 1."fsv_index" keeps track of the current index in the original filtered_string_view.
-	 *
-	 * 2."rcount_index" keeps track of the current index in the substring.
-	 *
-	 * 3.The function checks if the current index in the original filtered_string_view is within
-	 *   the range of the substring. If true, then the function checks if the character satisfies
-	 *   the predicate of the original filtered_string_view. If true, then the function checks if
-	 *   the current index in the substring is less than the specified count. If true, then the
-	 *   function returns "true", indicating that the character should be included in the substring.
-	 *   The function increments "rcount_index" in this case.
-	 *
-	 * 4.After checking if the character should be included in the substring, the function increments "fsv_index".
-	 *
-	 * 5.If "fsv_index" reaches the end of the original filtered_string_view, then it is
-	 *   reset to 0 and "rcount_index" is reset to 0.
-	 *
-	 * 6.The function is mutable, which means that it can modify its captured variables.
-	 *
-	 * @param fsv_predicate The predicate function of the original filtered_string_view.
-	 * @param substr_start The starting index of the substring.
-	 * @param size_fsv_data The size of the original filtered_string_view.
-	 * @param rcount The count of characters in the substring.
-	 * @return A predicate to filter a substring of the original filtered_string_view.
-	 */
-	auto filter_substr(const fsv::filter fsv_predicate,
-	                   const std::size_t substr_start,
-	                   const std::size_t size_fsv_data,
-	                   const std::size_t rcount) noexcept -> fsv::filter {
-		auto fsv_index = std::size_t{0};
-		auto rcount_index = std::size_t{0};
-		return [fsv_predicate, fsv_index, substr_start, size_fsv_data, rcount, rcount_index](const char& c) mutable {
-			auto result = false;
-			if (fsv_index >= substr_start and fsv_index <= size_fsv_data) {
-				if (fsv_predicate(c)) {
-					if (rcount_index < rcount) {
-						result = true;
-						++rcount_index;
-					}
-				}
-			}
-			++fsv_index;
-			if (fsv_index == size_fsv_data) {
-				fsv_index = 0;
-				rcount_index = 0;
-			}
-			return result;
-		};
+	// With a single opaque filter there is nothing to reorder.
+	predicate_ = opts.has_value() and opaque.size() >= 2
+	                 ? std::make_shared<const filter>(composed_filter{table, std::move(opaque), *opts})
+	                 : std::make_shared<const filter>(composed_filter{table, std::move(opaque)});
+	table_ = std::nullopt;
+	identity_ = false;
+}
+
+// Split View - Constructor
+fsv::split_view::split_view(const filtered_string_view& fsv, const filtered_string_view& tok) noexcept
+: fsv_{fsv}
+, tok_{tok}
+, whole_{fsv.empty() or tok.empty()} {}
+
+// Split View - begin()
+auto fsv::split_view::begin() const noexcept -> iterator {
+	return iterator{this, fsv_.first_};
+}
+
+// Split View - end()
+auto fsv::split_view::end() const noexcept -> iterator {
+	return iterator{};
+}
+
+// helper function - next_delimiter
+auto fsv::split_view::next_delimiter(const char* from) const noexcept -> std::pair<const char*, const char*> {
+	const auto* last = fsv_.last_;
+	if (whole_) {
+		return {last, last};
 	}
-} // namespace
+
+	// Nothing is filtered out of either side, so the raw bytes can be searched directly.
+	if (fsv_.identity_ and tok_.identity_) {
+		const auto offset =
+		    detail::find_substring(from, static_cast<std::size_t>(last - from), tok_.first_, tok_.raw_size());
+		if (offset == static_cast<std::size_t>(last - from)) {
+			return {last, last};
+		}
+		return {from + offset, from + offset + tok_.raw_size()};
+	}
+
+	return with_keep(fsv_.table_, *fsv_.predicate_, [&](const auto& keep) {
+		return with_keep(tok_.table_, *tok_.predicate_, [&](const auto& tok_keep) {
+			return find_filtered(from, last, keep, tok_.first_, tok_.last_, tok_keep);
+		});
+	});
+}
+
+// Split View Iterator - Constructor
+fsv::split_view::iter::iter(const split_view* owner, const char* piece_first) noexcept
+: owner_{owner}
+, piece_first_{piece_first}
+, piece_last_{}
+, resume_{}
+, done_{false} {
+	std::tie(piece_last_, resume_) = owner_->next_delimiter(piece_first_);
+}
+
+// Split View Iterator - Dereference
+auto fsv::split_view::iter::operator*() const noexcept -> reference {
+	// Every piece is a bounded view over its own sub-range of fsv's raw bytes, sharing fsv's
+	// predicate, so iterating a piece only ever touches the bytes between two delimiters.
+	return filtered_string_view{owner_->fsv_, piece_first_, piece_last_};
+}
+
+// Split View Iterator - Pre Increment
+auto fsv::split_view::iter::operator++() noexcept -> iter& {
+	if (piece_last_ == owner_->fsv_.last_) {
+		done_ = true;
+		piece_first_ = nullptr;
+		piece_last_ = nullptr;
+		resume_ = nullptr;
+		return *this;
+	}
+
+	// Move past tok and find its next occurrence.
+	piece_first_ = resume_;
+	std::tie(piece_last_, resume_) = owner_->next_delimiter(piece_first_);
+	return *this;
+}
+
+// Split View Iterator - Post Increment
+auto fsv::split_view::iter::operator++(int) noexcept -> iter {
+	auto copy = *this;
+	++*this;
+	return copy;
+}
 
 // Non-Member Utility Function - Split
 auto fsv::split(const filtered_string_view& fsv, const filtered_string_view& tok) noexcept
     -> std::vector<filtered_string_view> {
-	auto result = std::vector<filtered_string_view>{};
-	if (fsv.empty() or tok.empty()) {
-		result.emplace_back(fsv);
-		return result;
-	}
+	const auto pieces = split_view{fsv, tok};
+	return std::vector<filtered_string_view>(pieces.begin(), pieces.end());
+}
 
-	auto fsv_data = std::string{fsv.data()};
-	auto tok_data = std::string{tok.data()};
-	auto size_fsv_data = fsv_data.size();
-	auto fsv_index = std::size_t{0};
+// Non-Member Utility Function - Write to File Descriptor
+auto fsv::write_to_fd(int fd, const filtered_string_view& fsv) -> std::size_t {
+	const auto runs = fsv.chunks();
+	auto run = runs.begin();
+	auto pending = std::array<iovec, IOV_MAX>{};
+	// pending[first, count) are the runs, or the rest of them, not yet written.
+	auto first = std::size_t{0};
+	auto count = std::size_t{0};
+	auto written = std::size_t{0};
+	while (true) {
+		// Top the batch back up after whatever the last call left unwritten, which overlaps where it goes.
+		if (first != 0) {
+			std::memmove(pending.data(), pending.data() + first, (count - first) * sizeof(iovec));
+			count -= first;
+			first = 0;
+		}
+		for (; count < pending.size() and run != runs.end(); ++run) {
+			const auto bytes = *run;
+			pending[count++] = iovec{const_cast<char*>(bytes.data()), bytes.size()};
+		}
+		if (count == 0) {
+			return written;
+		}
 
-	// Find the first occurrence of tok in fsv. The return value is the index of the
-	// first character of tok, or std::string::npos if not found.
-	auto end_split_index = fsv_data.find(tok_data);
+		const auto result = ::writev(fd, pending.data(), static_cast<int>(count));
+		if (result < 0) {
+			if (errno == EINTR) {
+				continue;
+			}
+			throw std::system_error{errno, std::generic_category(), "fsv::write_to_fd"};
+		}
 
-	// Split fsv into substrings based on tok until tok is not found.
-	while (end_split_index != std::string::npos) {
-		// Add the substring from fsv_index to split_index - 1 to the result vector.
-		// The filter_split function is used to calculate a predicate that filters the substring.
-		result.emplace_back(fsv.data(), filter_split(fsv.predicate(), size_fsv_data, fsv_index, end_split_index - 1));
+		auto remaining = static_cast<std::size_t>(result);
+		written += remaining;
+		for (; first < count and remaining >= pending[first].iov_len; ++first) {
+			remaining -= pending[first].iov_len;
+		}
+		if (remaining > 0) {
+			pending[first].iov_base = static_cast<char*>(pending[first].iov_base) + remaining;
+			pending[first].iov_len -= remaining;
+		}
+	}
+}
 
-		// Move fsv_index to the position after tok.
-		fsv_index = end_split_index + tok_data.size();
+// Non-Member Utility Function - Substr
+auto fsv::substr(const filtered_string_view& fsv, std::size_t pos, std::size_t count) noexcept -> filtered_string_view {
+	// One forward scan finds the first kept char and carries on from there to one past the last,
+	// or two selects do when fsv has an index.
+	const auto* first = fsv.kept_from(fsv.first_, pos);
+	const auto* last = count == 0 ? fsv.last_ : fsv.kept_from(first, count);
+	return filtered_string_view{fsv, first, last};
+}
 
-		// Find the next occurrence of tok in fsv. The return value is the index of the
-		// first character of tok, or std::string::npos if not found.
-		end_split_index = fsv_data.find(tok_data, fsv_index);
-	}
+// Member Function - rebind
+auto fsv::filtered_string_view::rebind(const char* str, std::size_t size) const noexcept -> filtered_string_view {
+	auto view = filtered_string_view{*this, str, str + size};
+	view.data_ = str;
+	view.size_ = size;
+	return view;
+}
 
-	// Add the substring from fsv_index to the end of fsv to the result vector.
-	// The filter_split function is used to calculate a predicate that filters the substring.
-	result.emplace_back(fsv.data(), filter_split(fsv.predicate(), size_fsv_data, fsv_index, fsv_data.size()));
-	return result;
+// Member Function - chunks
+auto fsv::filtered_string_view::chunks() const noexcept -> chunk_view {
+	return chunk_view{*this};
 }
 
-// Non-Member Utility Function - Substr
-auto fsv::substr(const filtered_string_view& fsv, int pos, int count) noexcept -> filtered_string_view {
-	auto fsv_string = std::string{fsv.data()};
-	auto size_fsv_data = fsv_string.size();
+// Chunk View - Constructor
+fsv::chunk_view::chunk_view(const filtered_string_view& fsv) noexcept
+: fsv_{fsv} {}
 
-	// If "count" is less than or equal to 0, then the substring will have a length equal
-	// to the length of the original filtered_string_view minus "pos".
-	auto rcount = count <= 0 ? static_cast<int>(size_fsv_data) - pos : count;
-	auto fsv_predicate = fsv.predicate();
+// Chunk View - begin()
+auto fsv::chunk_view::begin() const noexcept -> iterator {
+	return iterator{this, fsv_.first_};
+}
 
-	// Initialize a variable to keep track of the number of characters that should be
-	// skipped at the beginning of the substring.
-	auto fsv_offset = 0;
+// Chunk View - end()
+auto fsv::chunk_view::end() const noexcept -> iterator {
+	return iterator{this, fsv_.last_};
+}
 
-	// Iterate over the characters of the underlying string of fsv. If a character
-	// satisfies the predicate function, then break out of the loop.
-	for (auto i = size_t{0}; i < size_fsv_data; ++i) {
-		if (fsv_predicate(fsv_string[i])) {
-			break;
-		}
-		++fsv_offset;
+// helper function - next_run
+auto fsv::chunk_view::next_run(const char* from) const noexcept -> std::pair<const char*, const char*> {
+	const auto* last = fsv_.last_;
+	if (fsv_.table_.has_value()) {
+		// A run starts at the first member and ends at the first non-member after it.
+		const auto* run_first = find_member(from, last, *fsv_.table_);
+		return {run_first, find_member(run_first, last, ~*fsv_.table_)};
 	}
+	const auto& predicate = *fsv_.predicate_;
+	const auto* run_first = std::find_if(from, last, std::cref(predicate));
+	return {run_first, std::find_if_not(run_first, last, std::cref(predicate))};
+}
+
+// Chunk View Iterator - Constructor
+fsv::chunk_view::iter::iter(const chunk_view* owner, const char* from) noexcept
+: owner_{owner}
+, run_first_{}
+, run_last_{} {
+	std::tie(run_first_, run_last_) = owner_->next_run(from);
+}
 
-	// Calculate the starting index of the substring based on the value of "pos" and
-	// the number of characters to skip at the beginning of the substring.
-	auto substr_start = static_cast<std::size_t>(pos + fsv_offset);
+// Chunk View Iterator - Dereference
+auto fsv::chunk_view::iter::operator*() const noexcept -> reference {
+	return {run_first_, run_last_};
+}
 
-	// Calculate a new predicate function that filters the substring based on the
-	// original predicate function and the starting index and length of the substring.
-	auto new_predicate = filter_substr(fsv_predicate, substr_start, size_fsv_data, static_cast<std::size_t>(rcount));
+// Chunk View Iterator - Pre Increment
+auto fsv::chunk_view::iter::operator++() noexcept -> iter& {
+	std::tie(run_first_, run_last_) = owner_->next_run(run_last_);
+	return *this;
+}
 
-	// Create a new filtered_string_view that represents the substring of the original
-	// filtered_string_view. The substring is created by using the underlying string
-	// of the original filtered_string_view and the new predicate function.
-	return filtered_string_view{fsv.data(), new_predicate};
+// Chunk View Iterator - Post Increment
+auto fsv::chunk_view::iter::operator++(int) noexcept -> iter {
+	auto copy = *this;
+	++*this;
+	return copy;
 }
 
 // Iterator
-fsv::filtered_string_view::iter::iter(const char* data, filter predicate) noexcept
+fsv::filtered_string_view::iter::iter(const char* data, const filtered_string_view& fsv) noexcept
 : data_{data}
-, predicate_{predicate} {
-	while (not(predicate_(*data_)) and *data_ != '\0') {
+, first_{fsv.first_}
+, last_{fsv.last_}
+, keep_{0} {
+	// The table is borrowed from the pure_filter inside the shared predicate, not from fsv, so the
+	// iterator does not depend on where fsv itself lives.
+	const auto* pure = fsv.table_.has_value() ? fsv.predicate_->target<pure_filter>() : nullptr;
+	if (pure != nullptr) {
+		keep_ = reinterpret_cast<std::uintptr_t>(&pure->table());
+	}
+	else if (fsv.identity_) {
+		keep_ = reinterpret_cast<std::uintptr_t>(&every_byte);
+	}
+	else {
+		keep_ = reinterpret_cast<std::uintptr_t>(fsv.predicate_.get()) | std::uintptr_t{1};
+	}
+	while (data_ != last_ and not(keeps(*data_))) {
 		++data_;
 	}
 };
 
+// helper function - keeps
+auto fsv::filtered_string_view::iter::keeps(const char& c) const noexcept -> bool {
+	if ((keep_ & std::uintptr_t{1}) == 0) {
+		return reinterpret_cast<const byte_set*>(keep_)->contains(c);
+	}
+	return (*reinterpret_cast<const filter*>(keep_ & ~std::uintptr_t{1}))(c);
+}
+
+// helper function - same_filter
+auto fsv::filtered_string_view::iter::same_filter(const iter& other) const noexcept -> bool {
+	if (keep_ == other.keep_ or keep_ == 0 or other.keep_ == 0) {
+		return true;
+	}
+	if (((keep_ ^ other.keep_) & std::uintptr_t{1}) != 0) {
+		return false;
+	}
+	if ((keep_ & std::uintptr_t{1}) == 0) {
+		return *reinterpret_cast<const byte_set*>(keep_) == *reinterpret_cast<const byte_set*>(other.keep_);
+	}
+	return reinterpret_cast<const filter*>(keep_ & ~std::uintptr_t{1})->target_type()
+	       == reinterpret_cast<const filter*>(other.keep_ & ~std::uintptr_t{1})->target_type();
+}
+
 // helper function - iterate_pre_increment
 auto fsv::filtered_string_view::iter::iterate_pre_increment() noexcept -> void {
+	if (data_ == last_) {
+		return;
+	}
 	do {
 		++data_;
-	} while (not(predicate_(*data_)) and *data_ != '\0');
+	} while (data_ != last_ and not(keeps(*data_)));
 }
 // helper function - iterate_pre_decrement
 auto fsv::filtered_string_view::iter::iterate_pre_decrement() noexcept -> void {
+	// Stops at the view's first byte even if it is filtered out, rather than reading before it.
+	if (data_ == first_) {
+		return;
+	}
 	do {
 		--data_;
-	} while (not(predicate_(*data_)) and *data_ != '\0');
+	} while (data_ != first_ and not(keeps(*data_)));
 }
 
 // Member Operator - Dereference
@@ -404,7 +1471,7 @@ auto fsv::filtered_string_view::iter::operator--(int) noexcept -> filtered_strin
 
 // Range - Normal Begin
 auto fsv::filtered_string_view::begin() const noexcept -> filtered_string_view::iterator {
-	return iterator{data_, predicate_};
+	return iterator{first_, *this};
 }
 
 // Range - Constant Begin
@@ -414,7 +1481,7 @@ auto fsv::filtered_string_view::cbegin() const noexcept -> filtered_string_view:
 
 // Range - Normal End
 auto fsv::filtered_string_view::end() const noexcept -> filtered_string_view::iterator {
-	return iterator{data_ + size_, predicate_};
+	return iterator{last_, *this};
 }
 
 // Range - Constant End
@@ -424,8 +1491,7 @@ auto fsv::filtered_string_view::cend() const noexcept -> filtered_string_view::c
 
 // Range - Reverse Begin
 auto fsv::filtered_string_view::rbegin() const noexcept -> filtered_string_view::reverse_iterator {
-	auto forward_rbegin = reverse_iterator{end()};
-	return forward_rbegin++;
+	return reverse_iterator{end()};
 }
 
 // Range - Constant Reverse Begin
@@ -436,8 +1502,7 @@ auto fsv::filtered_string_view::crbegin() const noexcept -> filtered_string_view
 // Range - Reverse End
 auto fsv::filtered_string_view::rend() const noexcept -> filtered_string_view::reverse_iterator {
 	// refer to https://en.cppreference.com/w/cpp/iterator/reverse_iterator
-	auto forward_rend = reverse_iterator{begin()};
-	return --forward_rend;
+	return reverse_iterator{begin()};
 }
 
 // Range - Constant Reverse End
@@ -2,18 +2,119 @@
 #define COMP6771_ASS2_FSV_H
 
 #include <algorithm>
+#include <chrono>
 #include <compare>
+#include <concepts>
+#include <cstdint>
 #include <cstring>
 #include <functional>
 #include <iterator>
+#include <memory>
 #include <optional>
 #include <ostream>
+#include <ranges>
+#include <span>
 #include <stdexcept>
+#include <string>
+#include <type_traits>
 #include <utility>
+#include <vector>
+
+#include "./byte_set.h"
+#include "./rank_select_index.h"
 
 namespace fsv {
 	using filter = std::function<bool(const char&)>;
 
+	/**
+	 * Declares a predicate pure: its result depends only on the char value. The predicate is
+	 * evaluated once for each of the 256 char values and only the resulting byte_set is kept.
+	 */
+	class pure_filter {
+	 public:
+		explicit pure_filter(const filter& predicate);
+		explicit pure_filter(const byte_set& table) noexcept;
+
+		auto operator()(const char& c) const noexcept -> bool;
+		[[nodiscard]] auto table() const noexcept -> const byte_set&;
+
+	 private:
+		byte_set table_;
+	};
+
+	// When and how often an adaptive compose measures its filters
+	struct adaptive_options {
+		// Calls at the start of every period whose chars are set aside, then run through every
+		// filter as one timed batch.
+		std::size_t sample = 1024;
+		// Calls on one thread to one filter and its copies between the starts of two samples. The
+		// order is re-checked after each sample.
+		std::size_t period = std::size_t{1} << 16U;
+	};
+
+	// What an adaptive compose has measured of one of its filters, over the sampled chars only
+	struct filter_stats {
+		std::size_t calls;
+		std::size_t rejections;
+		std::chrono::nanoseconds time;
+	};
+
+	// Counters of an adaptive compose, as reported by composed_filter::stats()
+	struct compose_stats {
+		// Indices into composed_filter::filters(), in the order they are currently called.
+		std::vector<std::size_t> order;
+		// Indexed like composed_filter::filters().
+		std::vector<filter_stats> filters;
+		std::size_t reorders;
+	};
+
+	/**
+	 * The flattened predicate compose builds: a char is kept when it is in table and every one of
+	 * filters keeps it. The filters are called in order and stop at the first rejection, and are
+	 * never called for a char the table already rejects.
+	 *
+	 * An adaptive composed_filter instead calls the filters in the order with the lowest expected
+	 * cost per char. Each thread sets aside the chars of a sample's calls, then runs every filter
+	 * over them as one timed batch and sorts the filters by time per char over rejection rate, so
+	 * a cheap filter that rejects often runs first. Between samples a call only walks the current
+	 * order and bumps a thread-local count. Copies share their measurements and order, and calls
+	 * from several threads at once are safe as long as the filters themselves are.
+	 */
+	class composed_filter {
+	 public:
+		composed_filter(const byte_set& table, std::vector<filter> filters) noexcept;
+		composed_filter(const byte_set& table, std::vector<filter> filters, const adaptive_options& opts);
+
+		auto operator()(const char& c) const -> bool;
+		[[nodiscard]] auto table() const noexcept -> const byte_set&;
+		[[nodiscard]] auto filters() const noexcept -> const std::vector<filter>&;
+
+		// The counters of an adaptive composed_filter, or std::nullopt if it calls its filters in order
+		[[nodiscard]] auto stats() const -> std::optional<compose_stats>;
+
+	 private:
+		struct adaptive_state;
+
+		byte_set table_;
+		std::vector<filter> filters_;
+		std::shared_ptr<adaptive_state> adaptive_;
+
+		[[nodiscard]] auto call_adaptive(const char& c) const -> bool;
+	};
+
+	// Where a search matched: the filtered index, and the raw byte of the view's data the match starts at
+	struct position {
+		std::size_t index;
+		const char* raw;
+	};
+
+	class chunk_view;
+	struct transparent_hash;
+
+	namespace detail {
+		class parallel_scan;
+	} // namespace detail
+
 	class filtered_string_view {
 		class iter {
 		 public:
@@ -26,7 +127,7 @@ namespace fsv {
 			using difference_type = std::ptrdiff_t;
 
 			iter() noexcept = default;
-			iter(const char* data, filter predicate) noexcept;
+			iter(const char* data, const filtered_string_view& fsv) noexcept;
 
 			auto operator*() const noexcept -> reference;
 			auto operator->() const noexcept -> pointer;
@@ -37,21 +138,26 @@ namespace fsv {
 			auto operator--(int) noexcept -> iter;
 
 			friend auto operator==(const iter& lhs, const iter& rhs) noexcept -> bool {
-				if (lhs.data_ != rhs.data_) {
-					return false;
-				}
-				if (lhs.predicate_.target_type() != rhs.predicate_.target_type()) {
-					return false;
-				}
-				return true;
+				return lhs.data_ == rhs.data_ and lhs.same_filter(rhs);
 			}
 			friend auto operator!=(const iter& lhs, const iter& rhs) noexcept -> bool {
 				return not(lhs == rhs);
 			}
 
 		 private:
-			const char* data_;
-			filter predicate_;
+			// Trivially copyable: the bounds are copied from the view, and the table or predicate is
+			// borrowed from the predicate the view shares with its copies and pieces, not from the
+			// view itself. An iterator stays valid when its view is moved or destroyed, as long as
+			// the string and one view sharing that predicate are still alive.
+			const char* data_ = nullptr;
+			const char* first_ = nullptr;
+			const char* last_ = nullptr;
+			// A const byte_set* when the view has a table, or else a const filter* with the low bit
+			// set. Both are at least 8-byte aligned, so the bit is free.
+			std::uintptr_t keep_ = 0;
+
+			[[nodiscard]] auto keeps(const char& c) const noexcept -> bool;
+			[[nodiscard]] auto same_filter(const iter& other) const noexcept -> bool;
 			void iterate_pre_increment() noexcept;
 			void iterate_pre_decrement() noexcept;
 		};
@@ -59,6 +165,7 @@ namespace fsv {
 	 public:
 		// Static Data Members
 		static filter default_predicate;
+		static constexpr std::size_t npos = std::string::npos;
 
 		// Default Constructor
 		filtered_string_view() noexcept;
@@ -69,12 +176,27 @@ namespace fsv {
 		// String Constructor with Predicate
 		filtered_string_view(const std::string& str, filter predicate) noexcept;
 
+		// String Constructor with Pure Predicate
+		filtered_string_view(const std::string& str, pure_filter predicate) noexcept;
+
 		// Implicit Null-Terminated String Constructor
 		filtered_string_view(const char* str) noexcept;
 
 		// Null-Terminated String with Predicate Constructor
 		filtered_string_view(const char* str, filter predicate) noexcept;
 
+		// Null-Terminated String with Pure Predicate Constructor
+		filtered_string_view(const char* str, pure_filter predicate) noexcept;
+
+		// Buffer Constructor
+		filtered_string_view(const char* str, std::size_t size) noexcept;
+
+		// Buffer with Predicate Constructor
+		filtered_string_view(const char* str, std::size_t size, filter predicate) noexcept;
+
+		// Buffer with Pure Predicate Constructor
+		filtered_string_view(const char* str, std::size_t size, pure_filter predicate) noexcept;
+
 		// Copy Constructor
 		filtered_string_view(const filtered_string_view& other) noexcept;
 
@@ -94,17 +216,78 @@ namespace fsv {
 		auto operator=(filtered_string_view&& other) noexcept -> filtered_string_view&;
 
 		// Subscript
-		auto operator[](int n) const noexcept -> const char&;
+		// Requires n < size(), which is asserted, while a negative n reads the first kept char as in
+		// basic_filtered_string_view. Any integer type is an exact match here, and only std::size_t
+		// goes to the overload below.
+		template<std::integral Index>
+		auto operator[](Index n) const noexcept -> const char& {
+			if constexpr (std::is_signed_v<Index>) {
+				return (*this)[static_cast<std::size_t>(std::max(n, Index{0}))];
+			}
+			else {
+				return (*this)[static_cast<std::size_t>(n)];
+			}
+		}
+		auto operator[](std::size_t n) const noexcept -> const char&;
 
 		// String Type Conversion
 		explicit operator std::string() const noexcept;
 
 		// Member Functions
-		[[nodiscard]] auto at(int index) const -> const char&;
+		template<std::integral Index>
+		[[nodiscard]] auto at(Index index) const -> const char& {
+			if constexpr (std::is_signed_v<Index>) {
+				if (index < 0) {
+					throw std::domain_error{"filtered_string_view::at(" + std::to_string(index) + "): invalid index"};
+				}
+			}
+			return at(static_cast<std::size_t>(index));
+		}
+		[[nodiscard]] auto at(std::size_t index) const -> const char&;
 		[[nodiscard]] auto size() const noexcept -> std::size_t;
 		[[nodiscard]] auto empty() const noexcept -> bool;
+		auto copy_to(char* out, std::size_t cap) const noexcept -> std::size_t;
 		[[nodiscard]] auto data() const noexcept -> const char*;
 		[[nodiscard]] auto predicate() const noexcept -> const filter&;
+		[[nodiscard]] auto table() const noexcept -> const std::optional<byte_set>&;
+
+		/**
+		 * Search in filtered space, with the results std::string's members would give on the
+		 * materialized string, but without materializing it. Chars are found by scanning the raw
+		 * bytes for candidates and checking only those against the predicate; substrings are
+		 * found in blocks of kept bytes compacted from the raw ones. ends_with, and rfind without a
+		 * pos, scan backwards from the last raw byte; rfind then counts the kept bytes before the
+		 * match to give its index, which costs nothing for identity and indexed views.
+		 */
+		[[nodiscard]] auto find(char c, std::size_t pos = 0) const noexcept -> std::size_t;
+		[[nodiscard]] auto find(const filtered_string_view& needle, std::size_t pos = 0) const noexcept -> std::size_t;
+		[[nodiscard]] auto rfind(char c, std::size_t pos = npos) const noexcept -> std::size_t;
+		[[nodiscard]] auto rfind(const filtered_string_view& needle, std::size_t pos = npos) const noexcept
+		    -> std::size_t;
+		[[nodiscard]] auto contains(char c) const noexcept -> bool;
+		[[nodiscard]] auto contains(const filtered_string_view& needle) const noexcept -> bool;
+		[[nodiscard]] auto starts_with(char c) const noexcept -> bool;
+		[[nodiscard]] auto starts_with(const filtered_string_view& needle) const noexcept -> bool;
+		[[nodiscard]] auto ends_with(char c) const noexcept -> bool;
+		[[nodiscard]] auto ends_with(const filtered_string_view& needle) const noexcept -> bool;
+
+		// find and rfind, also giving the raw byte the match starts at, or {npos, nullptr} if there is none.
+		// An empty needle matches at the kept char at its index, or at the end of the view.
+		[[nodiscard]] auto locate(char c, std::size_t pos = 0) const noexcept -> position;
+		[[nodiscard]] auto locate(const filtered_string_view& needle, std::size_t pos = 0) const noexcept -> position;
+		[[nodiscard]] auto rlocate(char c, std::size_t pos = npos) const noexcept -> position;
+		[[nodiscard]] auto rlocate(const filtered_string_view& needle, std::size_t pos = npos) const noexcept
+		    -> position;
+
+		// A view of str's size bytes with this view's predicate, which is shared rather than copied
+		[[nodiscard]] auto rebind(const char* str, std::size_t size) const noexcept -> filtered_string_view;
+
+		// Maximal runs of adjacent kept chars
+		[[nodiscard]] auto chunks() const noexcept -> chunk_view;
+
+		// Opt-in Rank/Select Index
+		auto enable_index() -> void;
+		[[nodiscard]] auto index_stats() const -> std::optional<fsv::index_stats>;
 
 		/**
 		 * Iterators Section
@@ -114,6 +297,8 @@ namespace fsv {
 		using reverse_iterator = std::reverse_iterator<iterator>;
 		using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
+		// Iterators outlive moves and reallocations of this view. They need the string, and this
+		// view or a copy or piece of it, to outlive them.
 		auto begin() const noexcept -> iterator;
 		auto cbegin() const noexcept -> const_iterator;
 
@@ -126,10 +311,169 @@ namespace fsv {
 		auto rend() const noexcept -> reverse_iterator;
 		auto crend() const noexcept -> const_reverse_iterator;
 
+		friend auto substr(const filtered_string_view& fsv, std::size_t pos, std::size_t count) noexcept
+		    -> filtered_string_view;
+
+		friend auto operator==(const filtered_string_view& lhs, const filtered_string_view& rhs) noexcept -> bool;
+		friend auto operator<=>(const filtered_string_view& lhs, const filtered_string_view& rhs) noexcept
+		    -> std::strong_ordering;
+		friend auto operator<<(std::ostream& os, const filtered_string_view& fsv) noexcept -> std::ostream&;
+		friend struct transparent_hash;
+		friend auto compose(const filtered_string_view& fsv, const std::vector<filter>& filts) noexcept
+		    -> filtered_string_view;
+		friend auto compose(const filtered_string_view& fsv,
+		                    const std::vector<filter>& filts,
+		                    const adaptive_options& opts) -> filtered_string_view;
+
 	 private:
+		friend class split_view;
+		friend class chunk_view;
+		friend class detail::parallel_scan;
+		struct lazy_index;
+
 		const char* data_;
 		std::size_t size_;
-		filter predicate_;
+		// The raw range [first_, last_) of data_ this view presents, which is all of it
+		// unless the view is a piece of a larger one.
+		const char* first_;
+		const char* last_;
+		// Shared by every copy and piece of a view, so copying a view never copies the filter.
+		std::shared_ptr<const filter> predicate_;
+		std::optional<byte_set> table_;
+		// Set when nothing is filtered out, so every raw byte is a kept char and the view can be
+		// handled as a plain char range.
+		bool identity_;
+		std::shared_ptr<lazy_index> index_;
+
+		// Bounded Constructor
+		filtered_string_view(const filtered_string_view& parent, const char* first, const char* last) noexcept;
+
+		[[nodiscard]] auto raw_size() const noexcept -> std::size_t;
+		[[nodiscard]] auto built_index() const -> const detail::rank_select_index*;
+		// The index if it has already been built, without building it
+		[[nodiscard]] auto ready_index() const noexcept -> const detail::rank_select_index*;
+		// size() when it is known without a scan, which it is for an identity or indexed view
+		[[nodiscard]] auto cached_size() const -> std::optional<std::size_t>;
+		[[nodiscard]] auto kept_from(const char* from, std::size_t n) const noexcept -> const char*;
+		// The number of kept bytes in [from, to)
+		[[nodiscard]] auto kept_between(const char* from, const char* to) const noexcept -> std::size_t;
+		// Keeps what table and every one of opaque keep, reordering opaque adaptively when opts is set
+		auto adopt(const byte_set& table, std::vector<filter> opaque, const std::optional<adaptive_options>& opts)
+		    -> void;
+	};
+
+	/**
+	 * A lazy split of fsv on tok, matching the bytes tok keeps against the bytes fsv keeps. Each
+	 * delimiter is found only when the iterator advances onto the piece before it, and each piece
+	 * is a bounded view sharing fsv's predicate, so stopping after the first few pieces costs only
+	 * the bytes scanned so far and no piece allocates.
+	 */
+	class split_view : public std::ranges::view_interface<split_view> {
+		class iter {
+		 public:
+			friend class split_view;
+
+			using iterator_concept = std::forward_iterator_tag;
+			// Pieces are produced by value, so only input iterator requirements are met classically.
+			using iterator_category = std::input_iterator_tag;
+			using value_type = filtered_string_view;
+			using reference = filtered_string_view;
+			using difference_type = std::ptrdiff_t;
+
+			iter() noexcept = default;
+
+			auto operator*() const noexcept -> reference;
+
+			auto operator++() noexcept -> iter&;
+			auto operator++(int) noexcept -> iter;
+
+			friend auto operator==(const iter& lhs, const iter& rhs) noexcept -> bool {
+				return lhs.done_ == rhs.done_ and (lhs.done_ or lhs.piece_first_ == rhs.piece_first_);
+			}
+
+		 private:
+			const split_view* owner_ = nullptr;
+			// The raw range of the current piece; piece_last_ is the delimiter after it, or fsv's end.
+			const char* piece_first_ = nullptr;
+			const char* piece_last_ = nullptr;
+			// Where the next piece starts: one past the delimiter's last kept byte.
+			const char* resume_ = nullptr;
+			bool done_ = true;
+
+			iter(const split_view* owner, const char* piece_first) noexcept;
+		};
+
+	 public:
+		using iterator = iter;
+
+		split_view() noexcept = default;
+		split_view(const filtered_string_view& fsv, const filtered_string_view& tok) noexcept;
+
+		auto begin() const noexcept -> iterator;
+		auto end() const noexcept -> iterator;
+
+	 private:
+		filtered_string_view fsv_;
+		filtered_string_view tok_;
+		// Whether fsv is yielded whole, as it is when either view is empty.
+		bool whole_ = true;
+
+		// The raw range of the next occurrence of tok's kept bytes among fsv's kept bytes
+		[[nodiscard]] auto next_delimiter(const char* from) const noexcept -> std::pair<const char*, const char*>;
+	};
+
+	/**
+	 * The kept chars of a view as its maximal runs of adjacent kept bytes, each a span into the
+	 * underlying data. Consumers that can take bytes in bulk (stream writes, hashing, memcpy)
+	 * get one call per run instead of one per char. Runs are found lazily as the iterator
+	 * advances, with the SIMD byte kernels when the predicate has been compiled.
+	 */
+	class chunk_view : public std::ranges::view_interface<chunk_view> {
+		class iter {
+		 public:
+			friend class chunk_view;
+
+			using iterator_concept = std::forward_iterator_tag;
+			// Runs are produced by value, so only input iterator requirements are met classically.
+			using iterator_category = std::input_iterator_tag;
+			using value_type = std::span<const char>;
+			using reference = std::span<const char>;
+			using difference_type = std::ptrdiff_t;
+
+			iter() noexcept = default;
+
+			auto operator*() const noexcept -> reference;
+
+			auto operator++() noexcept -> iter&;
+			auto operator++(int) noexcept -> iter;
+
+			friend auto operator==(const iter& lhs, const iter& rhs) noexcept -> bool {
+				return lhs.run_first_ == rhs.run_first_;
+			}
+
+		 private:
+			const chunk_view* owner_ = nullptr;
+			// The raw range of the current run, both the view's last byte once past the final run.
+			const char* run_first_ = nullptr;
+			const char* run_last_ = nullptr;
+
+			iter(const chunk_view* owner, const char* from) noexcept;
+		};
+
+	 public:
+		using iterator = iter;
+
+		chunk_view() noexcept = default;
+		explicit chunk_view(const filtered_string_view& fsv) noexcept;
+
+		auto begin() const noexcept -> iterator;
+		auto end() const noexcept -> iterator;
+
+	 private:
+		filtered_string_view fsv_;
+
+		// The first run starting at or after from
+		[[nodiscard]] auto next_run(const char* from) const noexcept -> std::pair<const char*, const char*>;
 	};
 
 	/**
@@ -148,15 +492,101 @@ namespace fsv {
 	 * Non-Member Utility Functions
 	 */
 	// Compose
+	// A view of fsv's bytes and bounds that keeps a char only when fsv's predicate and every filter
+	// in filts keep it. Pure filters and composed views are flattened rather than nested.
 	auto compose(const filtered_string_view& fsv, const std::vector<filter>& filts) noexcept -> filtered_string_view;
 
+	/**
+	 * compose with adaptive filter ordering: the opaque filters of the result are called in the
+	 * order that has proven cheapest so far rather than in the order given, so the short-circuit
+	 * guarantee holds for that order instead. Pure filters are still folded into one table.
+	 * With fewer than two opaque filters there is nothing to order and this is compose(fsv, filts).
+	 *
+	 * @throws std::bad_alloc if the shared counters cannot be allocated.
+	 */
+	auto compose(const filtered_string_view& fsv, const std::vector<filter>& filts, const adaptive_options& opts)
+	    -> filtered_string_view;
+
 	// Split
+	// Eagerly collects every piece of split_view{fsv, tok}.
 	auto split(const filtered_string_view& fsv, const filtered_string_view& tok) noexcept
 	    -> std::vector<filtered_string_view>;
 
+	/**
+	 * Writes the kept chars of fsv to fd without copying them, handing the view's kept runs to
+	 * writev in batches of at most IOV_MAX and resuming after partial writes.
+	 *
+	 * This pays off only when runs are long. Every run costs the kernel an iovec, so when fsv drops
+	 * a byte every hundred or so, writing static_cast<std::string>(fsv) in one write is about three
+	 * times faster. Runs of kilobytes and up are where this is faster, about twice as fast at 64 KiB.
+	 *
+	 * @return The number of bytes written, which is fsv.size().
+	 * @throws std::system_error if writev fails for any reason other than EINTR.
+	 */
+	auto write_to_fd(int fd, const filtered_string_view& fsv) -> std::size_t;
+
 	// SubStr
-	auto substr(const filtered_string_view& fsv, int pos = 0, int count = 0) noexcept -> filtered_string_view;
+	// A bounded view of fsv's kept chars [pos, pos + rcount), sharing fsv's predicate.
+	auto substr(const filtered_string_view& fsv, std::size_t pos, std::size_t count) noexcept -> filtered_string_view;
+	// At any integer types, with negatives taken as 0. Only std::size_t ones go to the overload above.
+	template<std::integral Pos = int, std::integral Count = Pos>
+	auto substr(const filtered_string_view& fsv, Pos pos = 0, Count count = 0) noexcept -> filtered_string_view {
+		const auto clamp = []<std::integral N>(N n) {
+			if constexpr (std::is_signed_v<N>) {
+				return static_cast<std::size_t>(std::max(n, N{0}));
+			}
+			else {
+				return static_cast<std::size_t>(n);
+			}
+		};
+		return substr(fsv, clamp(pos), clamp(count));
+	}
+
+	/**
+	 * Transparent hash and equality, so unordered containers keyed by filtered_string_view or
+	 * by std::string can be searched with either, or with a raw char range, without materializing
+	 * a string. Equal kept chars always hash the same, whatever holds them and however they are
+	 * filtered. Raw ranges are std::span<const char>, since this library does not use string_view.
+	 */
+	struct transparent_hash {
+		using is_transparent = void;
+
+		auto operator()(const filtered_string_view& fsv) const noexcept -> std::size_t;
+		auto operator()(const std::string& str) const noexcept -> std::size_t;
+		auto operator()(std::span<const char> chars) const noexcept -> std::size_t;
+		auto operator()(const char* str) const noexcept -> std::size_t;
+	};
+
+	struct transparent_equal {
+		using is_transparent = void;
 
+		template<typename Lhs, typename Rhs>
+		auto operator()(const Lhs& lhs, const Rhs& rhs) const noexcept -> bool {
+			return as_view(lhs) == as_view(rhs);
+		}
+
+	 private:
+		static auto as_view(const filtered_string_view& fsv) noexcept -> const filtered_string_view& {
+			return fsv;
+		}
+		static auto as_view(const std::string& str) noexcept -> filtered_string_view {
+			return filtered_string_view{str};
+		}
+		static auto as_view(std::span<const char> chars) noexcept -> filtered_string_view {
+			return filtered_string_view{chars.data(), chars.size()};
+		}
+		static auto as_view(const char* str) noexcept -> filtered_string_view {
+			return filtered_string_view{str};
+		}
+	};
 } // namespace fsv
 
+// Hashes the kept chars, to the same value as transparent_hash gives their materialized string.
+template<>
+struct std::hash<fsv::filtered_string_view> {
+	auto operator()(const fsv::filtered_string_view& fsv) const noexcept -> std::size_t {
+		return fsv::transparent_hash{}(fsv);
+	}
+};
+
 #endif // COMP6771_ASS2_FSV_H
@@ -1,8 +1,16 @@
 #include "./filtered_string_view.h"
 
+#include <array>
 #include <catch2/catch.hpp>
+#include <cstdint>
+#include <cstring>
 #include <set>
 #include <sstream>
+#include <sys/mman.h>
+#include <unistd.h>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 TEST_CASE("Default Constructor") {
 	const auto sv = fsv::filtered_string_view{};
@@ -191,6 +199,65 @@ TEST_CASE("Output Stream") {
 	CHECK(str == expected_str);
 }
 
+TEST_CASE("Output Stream - one write per kept run") {
+	struct counting_buffer : std::streambuf {
+		std::size_t writes = 0;
+		std::size_t bytes = 0;
+		auto xsputn(const char*, std::streamsize count) -> std::streamsize override {
+			++writes;
+			bytes += static_cast<std::size_t>(count);
+			return count;
+		}
+		auto overflow(int_type c) -> int_type override {
+			++writes;
+			++bytes;
+			return c;
+		}
+	};
+	auto str = std::string(1 << 20, 'x');
+	for (auto i = std::size_t{0}; i < str.size(); i += 4096) {
+		str[i] = '\n';
+	}
+	auto buffer = counting_buffer{};
+	auto os = std::ostream{&buffer};
+	os << fsv::filtered_string_view{str, fsv::pure_filter{[](const char& c) { return c != '\n'; }}};
+	CHECK(buffer.bytes == str.size() - 256);
+	CHECK(buffer.writes == 256);
+}
+
+static_assert(std::ranges::forward_range<fsv::chunk_view>);
+
+TEST_CASE("Chunks - maximal runs of kept bytes") {
+	const auto str = std::string{"--ab-c---def-"};
+	const auto expected = std::vector<std::string>{"ab", "c", "def"};
+	for (const auto& sv : {fsv::filtered_string_view{str, [](const char& c) { return c != '-'; }},
+	                       fsv::filtered_string_view{str, fsv::pure_filter{[](const char& c) { return c != '-'; }}}})
+	{
+		auto runs = std::vector<std::string>{};
+		for (const auto run : sv.chunks()) {
+			CHECK(run.data() >= str.data());
+			runs.emplace_back(run.begin(), run.end());
+		}
+		CHECK(runs == expected);
+	}
+	CHECK(std::ranges::distance(fsv::filtered_string_view{str}.chunks()) == 1);
+	CHECK(std::ranges::empty(fsv::filtered_string_view{}.chunks()));
+	CHECK(std::ranges::empty(fsv::filtered_string_view{"---", [](const char& c) { return c != '-'; }}.chunks()));
+}
+
+TEST_CASE("Chunks - long runs with a compiled predicate") {
+	auto str = std::string(1000, 'k');
+	for (const auto position : {0, 1, 2, 64, 500, 999}) {
+		str[static_cast<std::size_t>(position)] = ' ';
+	}
+	const auto sv = fsv::filtered_string_view{str, fsv::pure_filter{[](const char& c) { return c != ' '; }}};
+	auto sizes = std::vector<std::size_t>{};
+	for (const auto run : sv.chunks()) {
+		sizes.push_back(run.size());
+	}
+	CHECK(sizes == std::vector<std::size_t>{61, 435, 498});
+}
+
 TEST_CASE("Compose") {
 	const auto best_languages = fsv::filtered_string_view{"c / c++"};
 	const auto vf = std::vector<fsv::filter>{[](const char& c) { return c == 'c' || c == '+' || c == '/'; },
@@ -266,6 +333,131 @@ TEST_CASE("Split - challenge") {
 	CHECK(v == expected_v);
 }
 
+TEST_CASE("Split - pieces only touch their own bytes") {
+	auto calls = std::size_t{0};
+	const auto str = std::string{"alpha,beta,gamma,delta"};
+	const auto sv = fsv::filtered_string_view{str, [&calls](const char&) {
+		                                          ++calls;
+		                                          return true;
+	                                          }};
+	const auto tok = fsv::filtered_string_view{","};
+	const auto v = fsv::split(sv, tok);
+	REQUIRE(v.size() == 4);
+	for (const auto& piece : v) {
+		CHECK(piece.data() == str.data());
+	}
+	calls = 0;
+	CHECK(static_cast<std::string>(v[1]) == "beta");
+	CHECK(calls == 4);
+	calls = 0;
+	auto gamma = std::string{};
+	for (auto it = v[2].begin(); it != v[2].end(); ++it) {
+		gamma.push_back(*it);
+	}
+	CHECK(gamma == "gamma");
+	CHECK(calls == 5);
+}
+
+TEST_CASE("Split - pieces are independent of call order") {
+	const auto sv = fsv::filtered_string_view{"a1/b22/c333", [](const char& c) { return c != '2'; }};
+	const auto v = fsv::split(sv, "/");
+	REQUIRE(v.size() == 3);
+	CHECK(v[2] == "c333");
+	CHECK(v[1].size() == 1);
+	CHECK(v[1] == "b");
+	CHECK(v[0][1] == '1');
+	CHECK(*v[2].rbegin() == '3');
+	CHECK(*std::prev(v[0].end()) == '1');
+}
+
+TEST_CASE("Split - pieces can be read concurrently") {
+	auto str = std::string{};
+	for (auto i = 0; i < 2000; ++i) {
+		str += "field" + std::to_string(i) + ";";
+	}
+	const auto pieces = fsv::split(fsv::filtered_string_view{str, [](const char& c) { return c != 'e'; }}, ";");
+	REQUIRE(pieces.size() == 2001);
+	auto sizes = std::vector<std::size_t>(2, 0);
+	auto reader = [&pieces](std::size_t& total) {
+		for (const auto& piece : pieces) {
+			total += static_cast<std::string>(piece).size();
+		}
+	};
+	auto first = std::thread{reader, std::ref(sizes[0])};
+	auto second = std::thread{reader, std::ref(sizes[1])};
+	first.join();
+	second.join();
+	CHECK(sizes[0] == sizes[1]);
+	CHECK(sizes[0] == fsv::filtered_string_view{str, [](const char& c) { return c != 'e' && c != ';'; }}.size());
+}
+
+TEST_CASE("Split - matches kept bytes across filtered-out bytes") {
+	const auto sv = fsv::filtered_string_view{"a:-:b:-:c", [](const char& c) { return c != '-'; }};
+	const auto v = fsv::split(sv, "::");
+	REQUIRE(v.size() == 3);
+	CHECK(v[0] == "a");
+	CHECK(v[1] == "b");
+	CHECK(v[2] == "c");
+}
+
+TEST_CASE("Split - token is filtered too") {
+	const auto sv = fsv::filtered_string_view{"a_,b_,c"};
+	const auto tok = fsv::filtered_string_view{"_,", [](const char& c) { return c != '_'; }};
+	const auto v = fsv::split(sv, tok);
+	REQUIRE(v.size() == 3);
+	CHECK(v[0] == "a_");
+	CHECK(v[1] == "b_");
+	CHECK(v[2] == "c");
+	CHECK(fsv::split(fsv::filtered_string_view{"x--y", [](const char& c) { return c != '-'; }}, "--").size() == 1);
+}
+
+TEST_CASE("Split - long unfiltered input") {
+	auto str = std::string{};
+	for (auto i = 0; i < 100; ++i) {
+		str += "value" + std::to_string(i) + "<->";
+	}
+	const auto v = fsv::split(str, "<->");
+	REQUIRE(v.size() == 101);
+	CHECK(v[0] == "value0");
+	CHECK(v[57] == "value57");
+	CHECK(v[100].empty());
+}
+
+static_assert(std::ranges::forward_range<fsv::split_view>);
+static_assert(std::ranges::view<fsv::split_view>);
+
+TEST_CASE("Split View - yields the same pieces as split") {
+	const auto sv = fsv::filtered_string_view{"xax/bbb/ccc/", [](const char& c) { return c != 'x'; }};
+	const auto pieces = fsv::split_view{sv, "/"};
+	const auto expected = fsv::split(sv, "/");
+	REQUIRE(std::ranges::distance(pieces) == 4);
+	CHECK(std::ranges::equal(pieces, expected));
+	CHECK(std::ranges::equal(fsv::split_view{"", "/"}, std::vector<fsv::filtered_string_view>{""}));
+	CHECK(std::ranges::equal(fsv::split_view{"a/b", ""}, std::vector<fsv::filtered_string_view>{"a/b"}));
+}
+
+TEST_CASE("Split View - delimiters are found only as the iterator advances") {
+	auto str = std::string{"a/b/c/d"};
+	const auto pieces = fsv::split_view{str, "/"};
+	auto it = pieces.begin();
+	CHECK(*it == "a");
+	str[3] = '-';
+	++it;
+	CHECK(*it == "b-c");
+	++it;
+	CHECK(*it == "d");
+	CHECK(++it == pieces.end());
+}
+
+TEST_CASE("Split View - stopping early") {
+	const auto sv = fsv::filtered_string_view{"id,name,email,phone,address"};
+	auto fields = std::vector<std::string>{};
+	for (const auto& field : fsv::split_view{sv, ","} | std::views::take(2)) {
+		fields.push_back(static_cast<std::string>(field));
+	}
+	CHECK(fields == std::vector<std::string>{"id", "name"});
+}
+
 TEST_CASE("Substr - without length") {
 	const auto sv = fsv::filtered_string_view{"Siberian Husky"};
 	const auto sub_sv = fsv::substr(sv, 9);
@@ -301,6 +493,46 @@ TEST_CASE("Substr") {
 	CHECK(sub_sv == expected_sub_sv);
 }
 
+TEST_CASE("Substr - is a bounded view") {
+	auto str = std::string{"Sled Dog"};
+	const auto sv = fsv::filtered_string_view{str, [](const char& c) { return c != ' '; }};
+	const auto sub_sv = fsv::substr(sv, 2, 3);
+	CHECK(sub_sv == "edD");
+	CHECK(sub_sv.size() == 3);
+	CHECK(sub_sv[2] == 'D');
+	CHECK(sub_sv.data() == str.data());
+	str[7] = 'x';
+	CHECK(sub_sv == "edD");
+	CHECK(fsv::substr(sv, 4) == "Dox");
+	CHECK(fsv::substr(sv, 10, 2).empty());
+}
+
+TEST_CASE("Substr - is reentrant and nests") {
+	const auto sv = fsv::filtered_string_view{"a1b2c3d4e5f6", [](const char& c) { return std::isalpha(c) != 0; }};
+	const auto sub_sv = fsv::substr(sv, 1, 4);
+	CHECK(sub_sv == "bcde");
+	CHECK(sub_sv == "bcde");
+	CHECK(static_cast<std::string>(sub_sv) == "bcde");
+	const auto nested = fsv::substr(fsv::substr(sub_sv, 1), 1, 1);
+	CHECK(nested == "d");
+	CHECK(nested.size() == 1);
+}
+
+TEST_CASE("Substr - uses the index") {
+	auto str = std::string{};
+	for (auto i = 0; i < 3000; ++i) {
+		str.push_back(static_cast<char>('a' + i % 26));
+	}
+	auto sv = fsv::filtered_string_view{str, [](const char& c) { return c != 'e'; }};
+	const auto expected = fsv::substr(sv, 1234, 100);
+	sv.enable_index();
+	const auto sub_sv = fsv::substr(sv, 1234, 100);
+	CHECK(sub_sv == expected);
+	CHECK(fsv::substr(sub_sv, 50) == fsv::substr(expected, 50));
+	CHECK(fsv::substr(sv, 2800).size() == sv.size() - 2800);
+	CHECK(fsv::substr(sv, 2900).empty());
+}
+
 TEST_CASE("Iterator - With default predicate") {
 	const auto expect = std::vector<char>{'c', 'o', 'r', 'g', 'i'};
 	auto result = std::vector<char>{};
@@ -422,7 +654,7 @@ TEST_CASE("Iterator - rend()") {
 	const auto expected_sv = fsv::filtered_string_view{"able"};
 	CHECK(sv == expected_sv);
 	auto it = sv.rend();
-	CHECK(*it == 'a');
+	CHECK(*std::prev(it) == 'a');
 }
 
 TEST_CASE("Iterator - crbegin()") {
@@ -440,7 +672,7 @@ TEST_CASE("Iterator - crend()") {
 	const auto expected_sv = fsv::filtered_string_view{"able"};
 	CHECK(sv == expected_sv);
 	auto it = sv.crend();
-	CHECK(*it == 'a');
+	CHECK(*std::prev(it) == 'a');
 }
 
 TEST_CASE("Iterator - Equality Comparison - not equal") {
@@ -508,3 +740,679 @@ TEST_CASE("Iterator - reverse loop with predicate") {
 		CHECK(*it == sv_string[i]);
 	}
 }
+
+TEST_CASE("Iterator - reverse range stays inside an unterminated buffer") {
+	const auto not_dash = [](const char& c) { return c != '-'; };
+	const auto buffer = std::array<char, 8>{'-', '-', 'a', 'b', 'c', 'x', 'y', 'z'};
+	const auto reversed = [](const fsv::filtered_string_view& sv) { return std::string(sv.rbegin(), sv.rend()); };
+
+	CHECK(reversed(fsv::filtered_string_view{buffer.data(), 0}).empty());
+	CHECK(reversed(fsv::filtered_string_view{buffer.data(), 2, not_dash}).empty());
+	CHECK(reversed(fsv::filtered_string_view{buffer.data() + 2, 1}) == "a");
+	CHECK(reversed(fsv::filtered_string_view{buffer.data(), 3, not_dash}) == "a");
+	CHECK(reversed(fsv::filtered_string_view{buffer.data() + 2, 3}) == "cba");
+	CHECK(reversed(fsv::filtered_string_view{buffer.data() + 1, 4, not_dash}) == "cba");
+
+	const auto sv = fsv::filtered_string_view{buffer.data() + 2, 1};
+	auto it = sv.end();
+	CHECK(++it == sv.end());
+	it = sv.begin();
+	CHECK(--it == sv.begin());
+}
+
+TEST_CASE("Iterator - borrows the view's predicate") {
+	static_assert(std::is_trivially_copyable_v<fsv::filtered_string_view::iterator>);
+	// The position, both raw bounds, and the borrowed table or predicate.
+	static_assert(sizeof(fsv::filtered_string_view::iterator) <= 4 * sizeof(void*));
+
+	struct counting_predicate {
+		int* copies;
+		counting_predicate(int* c)
+		: copies{c} {}
+		counting_predicate(const counting_predicate& other)
+		: copies{other.copies} {
+			++*copies;
+		}
+		auto operator()(const char& c) const -> bool {
+			return c != '-';
+		}
+	};
+	auto copies = 0;
+	const auto sv = fsv::filtered_string_view{"a-b-c-d", counting_predicate{&copies}};
+	const auto baseline = copies;
+	CHECK(std::count(sv.begin(), sv.end(), 'c') == 1);
+	CHECK(sv == "abcd");
+	CHECK(*sv.rbegin() == 'd');
+	auto it = sv.begin();
+	it++;
+	CHECK(*it == 'b');
+	CHECK(copies == baseline);
+}
+
+TEST_CASE("Iterator - outlives its view") {
+	// A temporary that shares its predicate with a live view, as every piece and substr does.
+	const auto text = std::string{"a-b-c"};
+	const auto sv = fsv::filtered_string_view{text, [](const char& c) { return c != '-'; }};
+	auto it = fsv::substr(sv, 1).begin();
+	CHECK(*++it == 'c');
+	auto whole = fsv::filtered_string_view{text}.begin();
+	CHECK(*++whole == '-');
+
+	const auto digits = std::string{"1x2x3"};
+	auto views = std::vector<fsv::filtered_string_view>{};
+	views.emplace_back(digits, fsv::pure_filter{[](const char& c) { return c != 'x'; }});
+	auto first = views.front().begin();
+	const auto last = views.front().end();
+	for (auto i = 0; i < 64; ++i) {
+		views.emplace_back(text);
+	}
+	CHECK(std::string(first, last) == "123");
+	CHECK(*++first == '2');
+
+	auto pieces = fsv::split_view{fsv::filtered_string_view{"ab/cd"}, "/"};
+	auto piece = pieces.begin();
+	CHECK(*(*piece).begin() == 'a');
+	++piece;
+	CHECK(*std::next((*piece).begin()) == 'd');
+}
+
+TEST_CASE("Iterator - stops at the view's bounds, not at a NUL") {
+	const auto frame = std::string{"HDR:a\0b\0c|TRAILER", 17};
+	const auto is_payload = [](const char& c) { return c != '\0'; };
+	const auto sv = fsv::filtered_string_view{frame.data() + 4, 5, is_payload};
+	CHECK(std::string(sv.begin(), sv.end()) == "abc");
+	CHECK(std::distance(sv.begin(), sv.end()) == 3);
+
+	const auto raw = fsv::filtered_string_view{frame};
+	CHECK(std::distance(raw.begin(), raw.end()) == 17);
+	CHECK(*std::prev(raw.end()) == 'R');
+}
+
+TEST_CASE("Iterator - decrement stops at the view's first byte") {
+	const auto buffer = std::string{"zz--ab--"};
+	const auto sv = fsv::filtered_string_view{buffer.data() + 2, 6, [](const char& c) { return c != '-'; }};
+	auto it = sv.end();
+	auto steps = 0;
+	while (it != sv.begin()) {
+		--it;
+		++steps;
+	}
+	CHECK(steps == 2);
+	CHECK(*it == 'a');
+	CHECK(*std::prev(sv.end()) == 'b');
+}
+
+TEST_CASE("Rank/Select Index - not enabled") {
+	const auto sv = fsv::filtered_string_view{"abc"};
+	CHECK(sv.index_stats() == std::nullopt);
+}
+
+TEST_CASE("Rank/Select Index - subscript, at, size and empty") {
+	auto sv = fsv::filtered_string_view{"only 90s kids understand", [](const char& c) { return c != ' '; }};
+	sv.enable_index();
+	CHECK(sv.size() == 21);
+	CHECK(!sv.empty());
+	CHECK(sv[0] == 'o');
+	CHECK(sv[4] == '9');
+	CHECK(sv[20] == 'd');
+	CHECK(sv.at(7) == 'k');
+	CHECK_THROWS_MATCHES(sv.at(21),
+	                     std::domain_error,
+	                     Catch::Matchers::Message("filtered_string_view::at(21): invalid index"));
+	CHECK_THROWS_MATCHES(sv.at(-1),
+	                     std::domain_error,
+	                     Catch::Matchers::Message("filtered_string_view::at(-1): invalid index"));
+}
+
+TEST_CASE("Rank/Select Index - empty filtered string") {
+	auto sv = fsv::filtered_string_view{"Border Collie", [](const char& c) { return c == 'z'; }};
+	sv.enable_index();
+	CHECK(sv.empty());
+	CHECK(sv.size() == 0);
+}
+
+TEST_CASE("Rank/Select Index - matches linear scan across blocks") {
+	auto str = std::string{};
+	for (auto i = 0; i < 5000; ++i) {
+		str.push_back(static_cast<char>('a' + (i * 7) % 26));
+	}
+	const auto pred = [](const char& c) { return c < 'j' || c == 'x'; };
+	const auto linear = fsv::filtered_string_view{str, pred};
+	auto indexed = fsv::filtered_string_view{str, pred};
+	indexed.enable_index();
+	REQUIRE(indexed.size() == linear.size());
+	for (auto i = 0; i < static_cast<int>(linear.size()); ++i) {
+		CHECK(&indexed[i] == &linear[i]);
+	}
+	const auto stats = indexed.index_stats();
+	REQUIRE(stats.has_value());
+	CHECK(stats->raw_bytes == str.size());
+	CHECK(stats->kept == linear.size());
+	CHECK(stats->memory_bytes >= str.size() / 8);
+}
+
+TEST_CASE("Rank/Select Index - shared by copies, dropped by move") {
+	auto sv = fsv::filtered_string_view{"Malamute", [](const char& c) { return c == 'a' || c == 'u'; }};
+	sv.enable_index();
+	const auto copy = sv;
+	CHECK(copy.index_stats().has_value());
+	CHECK(copy[2] == 'u');
+	const auto moved = std::move(sv);
+	CHECK(moved.index_stats().has_value());
+	CHECK(sv.index_stats() == std::nullopt);
+}
+
+TEST_CASE("Pure Filter - evaluates the predicate once per char value") {
+	auto calls = 0;
+	const auto is_digit = fsv::pure_filter{[&calls](const char& c) {
+		++calls;
+		return c >= '0' && c <= '9';
+	}};
+	CHECK(calls == 256);
+	CHECK(is_digit('7'));
+	CHECK(!is_digit('x'));
+	CHECK(is_digit.table().count() == 10);
+	const auto sv = fsv::filtered_string_view{"route 66 to 1999", is_digit};
+	CHECK(calls == 256);
+	CHECK(sv.table().has_value());
+	CHECK(sv.size() == 6);
+	CHECK(static_cast<std::string>(sv) == "661999");
+	CHECK(sv[2] == '1');
+	CHECK(sv.at(5) == '9');
+	CHECK(calls == 256);
+}
+
+TEST_CASE("Pure Filter - iterator uses the table") {
+	const auto no_vowels = fsv::pure_filter{[](const char& c) {
+		return !(c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u');
+	}};
+	const auto str = std::string{"samoyed"};
+	const auto sv = fsv::filtered_string_view{str, no_vowels};
+	CHECK(sv == "smyd");
+	CHECK(std::string(sv.rbegin(), sv.rend()) == "dyms");
+	CHECK(*std::prev(sv.end()) == 'd');
+}
+
+TEST_CASE("Pure Filter - predicate() still answers through the table") {
+	const auto sv = fsv::filtered_string_view{"abc", fsv::pure_filter{[](const char& c) { return c == 'b'; }}};
+	CHECK(sv.predicate()('b'));
+	CHECK(!sv.predicate()('a'));
+}
+
+TEST_CASE("Pure Filter - default predicate is compiled, opaque predicate is not") {
+	CHECK(fsv::filtered_string_view{"abc"}.table() == fsv::byte_set::all());
+	CHECK(fsv::filtered_string_view{}.table() == fsv::byte_set::all());
+	CHECK(!fsv::filtered_string_view{"abc", [](const char&) { return true; }}.table().has_value());
+}
+
+TEST_CASE("Compose - pure filters merge into one table") {
+	const auto best_languages = fsv::filtered_string_view{"c / c++"};
+	const auto vf =
+	    std::vector<fsv::filter>{fsv::pure_filter{[](const char& c) { return c == 'c' || c == '+' || c == '/'; }},
+	                             fsv::pure_filter{[](const char& c) { return c > ' '; }}};
+	const auto sv = fsv::compose(best_languages, vf);
+	REQUIRE(sv.table().has_value());
+	CHECK(sv.table()->count() == 3);
+	CHECK(sv == "c/c++");
+}
+
+TEST_CASE("Compose - keeps the source bounds and predicate") {
+	const auto buffer = std::string{"ab\0cd\0ef", 8};
+	const auto no_nul = fsv::filtered_string_view{buffer, [](const char& c) { return c != '\0'; }};
+	const auto sv = fsv::compose(no_nul, {[](const char& c) { return c != 'c'; }});
+	CHECK(sv.data() == buffer.data());
+	CHECK(sv == "abdef");
+
+	const auto piece = fsv::substr(fsv::filtered_string_view{buffer.data(), buffer.size()}, 1, 5);
+	const auto composed = fsv::compose(piece, {fsv::pure_filter{[](const char& c) { return c != 'c'; }}});
+	CHECK(composed.size() == 4);
+	CHECK(static_cast<std::string>(composed) == std::string("b\0d\0", 4));
+	CHECK(fsv::compose(piece, {}) == piece);
+}
+
+TEST_CASE("Compose - nested composition stays flat") {
+	auto calls = std::vector<int>{};
+	const auto first = [&calls](const char& c) {
+		calls.push_back(1);
+		return c != 'x';
+	};
+	const auto second = [&calls](const char& c) {
+		calls.push_back(2);
+		return c != 'y';
+	};
+	const auto not_z = fsv::pure_filter{[](const char& c) { return c != 'z'; }};
+	const auto not_w = fsv::pure_filter{[](const char& c) { return c != 'w'; }};
+
+	auto sv = fsv::compose(fsv::filtered_string_view{"axbyczdw"}, {first, not_z});
+	sv = fsv::compose(sv, {second, not_w});
+	const auto* composed = sv.predicate().target<fsv::composed_filter>();
+	REQUIRE(composed != nullptr);
+	CHECK(composed->filters().size() == 2);
+	CHECK(composed->table().count() == 254);
+	CHECK(not sv.table().has_value());
+
+	// The table rejects 'z' and 'w' without calling either filter, and 'x' stops at the first one.
+	calls.clear();
+	CHECK(sv == "abcd");
+	CHECK(calls == std::vector<int>{1, 2, 1, 1, 2, 1, 2, 1, 2, 1, 2});
+}
+
+TEST_CASE("Compose - pure chains collapse to one table") {
+	auto sv = fsv::filtered_string_view{"hello world", fsv::pure_filter{[](const char& c) { return c != ' '; }}};
+	for (const auto c : std::string{"hel"}) {
+		sv = fsv::compose(sv, {fsv::pure_filter{[c](const char& d) { return d != c; }}});
+	}
+	REQUIRE(sv.table().has_value());
+	CHECK(sv.predicate().target<fsv::pure_filter>() != nullptr);
+	CHECK(sv == "oword");
+	CHECK(fsv::compose(fsv::filtered_string_view{"abc"}, {fsv::pure_filter{[](const char&) { return true; }}}) == "abc");
+}
+
+TEST_CASE("Compose - adaptive order runs the rejecting filter first") {
+	auto text = std::string{};
+	for (auto i = 0; i < 20000; ++i) {
+		text += "a1b2c3 ";
+	}
+	const auto keeps_all = [](const char& c) { return c != '\n'; };
+	const auto is_digit = [](const char& c) { return c >= '0' and c <= '9'; };
+	const auto not_three = fsv::pure_filter{[](const char& c) { return c != '3'; }};
+	const auto opts = fsv::adaptive_options{.sample = 64, .period = 256};
+
+	const auto sv = fsv::compose(fsv::filtered_string_view{text}, {keeps_all, not_three, is_digit}, opts);
+	const auto expected = fsv::compose(fsv::filtered_string_view{text}, {keeps_all, not_three, is_digit});
+	CHECK(sv == expected);
+	CHECK(sv.size() == 40000);
+
+	const auto* composed = sv.predicate().target<fsv::composed_filter>();
+	REQUIRE(composed != nullptr);
+	const auto stats = composed->stats();
+	REQUIRE(stats.has_value());
+	CHECK(stats->order == std::vector<std::size_t>{1, 0});
+	CHECK(stats->reorders == 1);
+	REQUIRE(stats->filters.size() == 2);
+	CHECK(stats->filters[0].rejections == 0);
+	CHECK(stats->filters[1].rejections > 0);
+	CHECK(stats->filters[1].calls >= stats->filters[1].rejections);
+	// Every filter is measured on the whole of each sample, however it is ordered.
+	CHECK(stats->filters[0].calls == stats->filters[1].calls);
+	CHECK(stats->filters[0].calls % 64 == 0);
+	CHECK(not expected.predicate().target<fsv::composed_filter>()->stats().has_value());
+}
+
+TEST_CASE("Compose - adaptive order follows a change in the input") {
+	const auto text = std::string(8192, 'x') + std::string(8192, 'y');
+	const auto not_x = [](const char& c) { return c != 'x'; };
+	const auto not_y = [](const char& c) { return c != 'y'; };
+	const auto sv = fsv::compose(fsv::filtered_string_view{text}, {not_y, not_x}, {.sample = 32, .period = 128});
+	const auto* composed = sv.predicate().target<fsv::composed_filter>();
+	REQUIRE(composed != nullptr);
+
+	CHECK(sv.empty());
+	CHECK(composed->stats()->order == std::vector<std::size_t>{0, 1});
+	CHECK(composed->stats()->reorders == 2);
+}
+
+TEST_CASE("Compose - adaptive filters called in turn each keep their own period") {
+	const auto keeps_all = [](const char& c) { return c != '\n'; };
+	const auto not_a = [](const char& c) { return c != 'a'; };
+	const auto opts = fsv::adaptive_options{.sample = 64, .period = 256};
+	const auto lhs = fsv::compose(fsv::filtered_string_view{"a"}, {keeps_all, not_a}, opts);
+	const auto rhs = fsv::compose(fsv::filtered_string_view{"a"}, {keeps_all, not_a}, opts);
+	const auto* lhs_composed = lhs.predicate().target<fsv::composed_filter>();
+	const auto* rhs_composed = rhs.predicate().target<fsv::composed_filter>();
+	REQUIRE(lhs_composed != nullptr);
+	REQUIRE(rhs_composed != nullptr);
+
+	for (auto i = 0; i < 1000; ++i) {
+		CHECK(not(*lhs_composed)('a'));
+		CHECK(not(*rhs_composed)('a'));
+	}
+	CHECK(lhs_composed->stats()->order == std::vector<std::size_t>{1, 0});
+	CHECK(lhs_composed->stats()->reorders == 1);
+	CHECK(rhs_composed->stats()->order == std::vector<std::size_t>{1, 0});
+	CHECK(rhs_composed->stats()->reorders == 1);
+}
+
+TEST_CASE("Compose - adaptive with a single opaque filter is plain compose") {
+	const auto sv = fsv::compose(fsv::filtered_string_view{"a b c"},
+	                             {fsv::pure_filter{[](const char& c) { return c != 'b'; }},
+	                              [](const char& c) { return c != ' '; }},
+	                             fsv::adaptive_options{});
+	CHECK(sv == "ac");
+	REQUIRE(sv.predicate().target<fsv::composed_filter>() != nullptr);
+	CHECK(not sv.predicate().target<fsv::composed_filter>()->stats().has_value());
+}
+
+TEST_CASE("Comparison - block compare agrees with the materialized strings") {
+	// Long enough to span several blocks, with chars on both sides of 0 when char is signed.
+	auto base = std::string{};
+	for (auto i = 0; i < 3000; ++i) {
+		base += static_cast<char>(i % 7 == 0 ? -100 + i % 50 : 'a' + i % 26);
+	}
+	const auto drop_x = [](const char& c) { return c != 'x'; };
+	auto texts = std::vector<std::string>{base, base + "q", base.substr(0, 2999), base};
+	texts[3][1700] = static_cast<char>(-1);
+	for (auto& text : std::vector<std::string>{base, base}) {
+		texts.push_back(text);
+	}
+	texts[4].insert(1000, "xxx");
+	texts[5].insert(513, std::string(600, 'x'));
+
+	const auto views = [&drop_x](const std::string& text) {
+		return std::vector<fsv::filtered_string_view>{fsv::filtered_string_view{text},
+		                                             fsv::filtered_string_view{text, drop_x},
+		                                             fsv::filtered_string_view{text, fsv::pure_filter{drop_x}}};
+	};
+	for (const auto& lhs_text : texts) {
+		for (const auto& rhs_text : texts) {
+			for (const auto& lhs : views(lhs_text)) {
+				for (const auto& rhs : views(rhs_text)) {
+					const auto lhs_string = static_cast<std::string>(lhs);
+					const auto rhs_string = static_cast<std::string>(rhs);
+					CHECK((lhs == rhs) == (lhs_string == rhs_string));
+					// Char by char: std::string's own <=> orders bytes as unsigned.
+					CHECK((lhs <=> rhs)
+					      == std::lexicographical_compare_three_way(lhs_string.begin(),
+					                                                lhs_string.end(),
+					                                                rhs_string.begin(),
+					                                                rhs_string.end()));
+				}
+			}
+		}
+	}
+}
+
+TEST_CASE("Comparison - differing cached sizes compare unequal without a scan") {
+	auto calls = 0;
+	const auto counted = [&calls](const char& c) {
+		++calls;
+		return c != ' ';
+	};
+	auto lhs = fsv::filtered_string_view{"a b c d", counted};
+	lhs.enable_index();
+	CHECK(lhs.size() == 4);
+	calls = 0;
+	CHECK(lhs != fsv::filtered_string_view{"abc"});
+	CHECK(calls == 0);
+	CHECK(lhs == fsv::filtered_string_view{"abcd"});
+	CHECK(calls == 7);
+}
+
+TEST_CASE("Hash - kept chars hash like their materialized string") {
+	auto text = std::string{};
+	for (auto i = 0; i < 500; ++i) {
+		text += "key-" + std::to_string(i) + "\r\n";
+	}
+	const auto no_cr = [](const char& c) { return c != '\r'; };
+	const auto hash = fsv::transparent_hash{};
+	for (const auto& sv : {fsv::filtered_string_view{text},
+	                       fsv::filtered_string_view{text, no_cr},
+	                       fsv::filtered_string_view{text, fsv::pure_filter{no_cr}},
+	                       fsv::substr(fsv::filtered_string_view{text, no_cr}, 10, 3)})
+	{
+		const auto materialized = static_cast<std::string>(sv);
+		CHECK(std::hash<fsv::filtered_string_view>{}(sv) == hash(materialized));
+		CHECK(hash(sv) == hash(std::span<const char>{materialized}));
+	}
+	CHECK(hash("abc") == hash(std::string{"abc"}));
+	CHECK(hash(fsv::filtered_string_view{"a-b-c", [](const char& c) { return c != '-'; }}) == hash("abc"));
+}
+
+TEST_CASE("Hash - heterogeneous lookup without materializing") {
+	auto keys = std::unordered_set<std::string, fsv::transparent_hash, fsv::transparent_equal>{"alpha", "beta"};
+	const auto sv = fsv::filtered_string_view{"a_l_p_h_a", [](const char& c) { return c != '_'; }};
+	CHECK(keys.find(sv) != keys.end());
+	CHECK(keys.contains(fsv::filtered_string_view{"beta!", fsv::pure_filter{[](const char& c) { return c != '!'; }}}));
+	CHECK(not keys.contains(fsv::filtered_string_view{"gamma"}));
+
+	auto counts = std::unordered_map<fsv::filtered_string_view, int>{};
+	++counts[sv];
+	++counts[fsv::filtered_string_view{"alpha"}];
+	++counts[fsv::filtered_string_view{"beta"}];
+	CHECK(counts.size() == 2);
+	CHECK(counts.at(fsv::filtered_string_view{"alpha"}) == 2);
+
+	const auto views = std::unordered_set<fsv::filtered_string_view, fsv::transparent_hash, fsv::transparent_equal>{sv};
+	CHECK(views.contains(std::string{"alpha"}));
+	CHECK(views.contains("alpha"));
+}
+
+TEST_CASE("Search - find and rfind agree with std::string") {
+	// Long enough that substring matches cross the blocks kept bytes are compacted in.
+	auto text = std::string{};
+	for (auto i = 0; i < 900; ++i) {
+		text += "ab-c" + std::to_string(i % 37) + (i % 5 == 0 ? "--" : "");
+	}
+	const auto no_dash = [](const char& c) { return c != '-'; };
+	for (const auto& sv : {fsv::filtered_string_view{text},
+	                       fsv::filtered_string_view{text, no_dash},
+	                       fsv::filtered_string_view{text, fsv::pure_filter{no_dash}},
+	                       fsv::substr(fsv::filtered_string_view{text, no_dash}, 7, 3000)})
+	{
+		const auto materialized = static_cast<std::string>(sv);
+		const auto npos = fsv::filtered_string_view::npos;
+		for (const auto pos : {std::size_t{0}, std::size_t{1}, std::size_t{2500}, materialized.size(), npos}) {
+			for (const auto c : {'a', 'c', '9', '-', 'z'}) {
+				CHECK(sv.find(c, pos) == materialized.find(c, pos));
+				CHECK(sv.rfind(c, pos) == materialized.rfind(c, pos));
+			}
+			for (const auto* needle : {"", "b", "c3", "c36ab", "bc1ab", "4ab-c", "c36abc0abc1", "zz"}) {
+				const auto pattern = std::string{needle};
+				CHECK(sv.find(needle, pos) == materialized.find(pattern, pos));
+				CHECK(sv.rfind(needle, pos) == materialized.rfind(pattern, pos));
+			}
+		}
+		CHECK(sv.contains("c36abc0") == (materialized.find("c36abc0") != std::string::npos));
+		CHECK(sv.starts_with("abc0") == materialized.starts_with("abc0"));
+		CHECK(sv.starts_with(materialized.front()));
+		CHECK(sv.ends_with("abc36") == materialized.ends_with("abc36"));
+		CHECK(sv.ends_with(materialized.back()));
+	}
+}
+
+TEST_CASE("Search - filtered needles and raw positions") {
+	const auto sv = fsv::filtered_string_view{"x.a.b.c.a.b", [](const char& c) { return c != '.'; }};
+	const auto needle = fsv::filtered_string_view{"a_b", [](const char& c) { return c != '_'; }};
+	const auto first = sv.locate(needle);
+	CHECK(first.index == 1);
+	CHECK(first.raw == sv.data() + 2);
+	const auto last = sv.rlocate(needle);
+	CHECK(last.index == 4);
+	CHECK(last.raw == sv.data() + 8);
+	CHECK(&sv[last.index] == last.raw);
+	CHECK(sv.locate('c').raw == sv.data() + 6);
+	CHECK(sv.rlocate('x').index == 0);
+	CHECK(sv.locate('.').raw == nullptr);
+	CHECK(sv.find('.') == fsv::filtered_string_view::npos);
+	CHECK(sv.ends_with(needle));
+	CHECK(not sv.starts_with(needle));
+	CHECK(not fsv::filtered_string_view{}.contains('a'));
+	CHECK(fsv::filtered_string_view{}.contains(""));
+}
+
+TEST_CASE("Search - prefixes and suffixes of a default view") {
+	const auto sv = fsv::filtered_string_view{};
+	CHECK(sv.starts_with(""));
+	CHECK(sv.ends_with(""));
+	CHECK(sv.starts_with(fsv::filtered_string_view{}));
+	CHECK(sv.ends_with(fsv::filtered_string_view{}));
+	CHECK(not sv.starts_with("a"));
+	CHECK(not sv.ends_with("a"));
+	CHECK(not sv.starts_with('a'));
+	CHECK(not sv.ends_with('a'));
+	CHECK(fsv::filtered_string_view{"abc"}.starts_with(sv));
+	CHECK(fsv::filtered_string_view{"abc"}.ends_with(sv));
+}
+
+TEST_CASE("Search - ends_with reads only the tail") {
+	auto calls = std::size_t{0};
+	const auto text = std::string(100000, 'x') + "tail";
+	const auto sv = fsv::filtered_string_view{text, [&calls](const char& c) {
+		                                          ++calls;
+		                                          return c != 'x';
+	                                          }};
+	CHECK(sv.ends_with("ail"));
+	CHECK(calls == 3);
+	calls = 0;
+	CHECK(sv.ends_with('l'));
+	CHECK(calls == 1);
+	CHECK(sv.rlocate('t').raw == text.data() + 100000);
+}
+
+TEST_CASE("Pure Filter - size and empty over long buffers") {
+	auto str = std::string(1000, 'x');
+	str[998] = '4';
+	const auto is_digit = fsv::pure_filter{[](const char& c) { return c >= '0' && c <= '9'; }};
+	const auto sv = fsv::filtered_string_view{str, is_digit};
+	CHECK(sv.size() == 1);
+	CHECK(!sv.empty());
+	str[998] = 'x';
+	CHECK(sv.empty());
+	CHECK(fsv::filtered_string_view{str}.size() == 1000);
+}
+
+TEST_CASE("copy_to") {
+	const auto sv = fsv::filtered_string_view{"c++ > rust > java", [](const char& c) { return c == 'c' || c == '+'; }};
+	auto out = std::string(8, '#');
+	CHECK(sv.copy_to(out.data(), out.size()) == 3);
+	CHECK(out == "c++#####");
+	CHECK(sv.copy_to(out.data(), 2) == 2);
+	CHECK(fsv::filtered_string_view{}.copy_to(out.data(), out.size()) == 0);
+}
+
+TEST_CASE("copy_to - pure predicate never writes past cap") {
+	auto str = std::string{};
+	for (auto i = 0; i < 500; ++i) {
+		str.push_back(static_cast<char>('a' + i % 26));
+	}
+	const auto no_vowels = fsv::pure_filter{[](const char& c) {
+		return !(c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u');
+	}};
+	const auto sv = fsv::filtered_string_view{str, no_vowels};
+	const auto expected = static_cast<std::string>(fsv::filtered_string_view{str, [](const char& c) {
+		                                               return !(c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u');
+	                                               }});
+	CHECK(static_cast<std::string>(sv) == expected);
+	for (const auto cap : {std::size_t{0}, std::size_t{1}, std::size_t{17}, std::size_t{100}, expected.size()}) {
+		auto out = std::string(cap + 40, '#');
+		CHECK(sv.copy_to(out.data(), cap) == cap);
+		CHECK(out.substr(0, cap) == expected.substr(0, cap));
+		CHECK(out.substr(cap) == std::string(40, '#'));
+	}
+}
+
+TEST_CASE("64-bit Indexing - size_t and ptrdiff_t overloads") {
+	const auto sv = fsv::filtered_string_view{"a1b2c3", [](const char& c) { return std::isdigit(c) != 0; }};
+	CHECK(sv[std::size_t{1}] == '2');
+	CHECK(sv[std::ptrdiff_t{2}] == '3');
+	CHECK(sv.at(std::size_t{0}) == '1');
+	CHECK_THROWS_MATCHES(sv.at(std::ptrdiff_t{-2}),
+	                     std::domain_error,
+	                     Catch::Matchers::Message("filtered_string_view::at(-2): invalid index"));
+	CHECK_THROWS_AS(sv.at(std::size_t{3}), std::domain_error);
+	CHECK(fsv::substr(sv, std::size_t{1}) == "23");
+	CHECK(fsv::substr(sv, std::ptrdiff_t{1}, std::ptrdiff_t{1}) == "2");
+}
+
+TEST_CASE("64-bit Indexing - every integer type picks one overload") {
+	const auto sv = fsv::filtered_string_view{"a1b2c3", [](const char& c) { return std::isdigit(c) != 0; }};
+	CHECK(sv[2u] == '3');
+	CHECK(sv[1LL] == '2');
+	CHECK(sv[1UL] == '2');
+	CHECK(sv[short{0}] == '1');
+	CHECK(sv[-1] == '1');
+	CHECK(sv[std::ptrdiff_t{-3}] == '1');
+	CHECK(sv.at(std::uint32_t{1}) == '2');
+	CHECK(sv.at(std::int64_t{2}) == '3');
+	CHECK_THROWS_AS(sv.at(3u), std::domain_error);
+	CHECK_THROWS_AS(sv.at(-1LL), std::domain_error);
+	CHECK(fsv::substr(sv, 1u, 2u) == "23");
+	CHECK(fsv::substr(sv, 1LL, 1LL) == "2");
+	CHECK(fsv::substr(sv, 1, std::size_t{1}) == "2");
+	CHECK(fsv::substr(sv, -1L) == "123");
+	CHECK(fsv::substr(sv) == "123");
+}
+
+TEST_CASE("64-bit Indexing - positions beyond 4 GiB") {
+	// Anonymous pages are only backed once written, so this reserves address space, not memory.
+	constexpr auto size = std::size_t{5} << 30U;
+	auto* mapping = ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+	if (mapping == MAP_FAILED) {
+		WARN("could not map 5 GiB of address space");
+		return;
+	}
+	auto* bytes = static_cast<char*>(mapping);
+	const auto far = (std::size_t{4} << 30U) + 12345;
+	std::memcpy(bytes + far, "xyz", 3);
+
+	const auto sv = fsv::filtered_string_view{bytes, size};
+	CHECK(sv.size() == size);
+	CHECK(sv[far] == 'x');
+	CHECK(sv.at(static_cast<std::ptrdiff_t>(far) + 1) == 'y');
+	CHECK(sv.at(size - 1) == '\0');
+	CHECK_THROWS_AS(sv.at(size), std::domain_error);
+	const auto sub_sv = fsv::substr(sv, far, std::size_t{3});
+	CHECK(sub_sv == "xyz");
+	CHECK(fsv::substr(sub_sv, std::size_t{2}) == "z");
+	::munmap(mapping, size);
+}
+
+TEST_CASE("write_to_fd - writes every kept run") {
+	auto str = std::string{};
+	for (auto i = 0; i < 5000; ++i) {
+		str += "run" + std::to_string(i) + ";";
+	}
+	const auto sv = fsv::filtered_string_view{str, [](const char& c) { return c != ';'; }};
+	auto* file = std::tmpfile();
+	REQUIRE(file != nullptr);
+	const auto fd = ::fileno(file);
+	CHECK(fsv::write_to_fd(fd, sv) == sv.size());
+	CHECK(fsv::write_to_fd(fd, fsv::filtered_string_view{}) == 0);
+
+	auto contents = std::string(sv.size() + 1, '#');
+	REQUIRE(::lseek(fd, 0, SEEK_SET) == 0);
+	CHECK(::read(fd, contents.data(), contents.size()) == static_cast<ssize_t>(sv.size()));
+	contents.pop_back();
+	CHECK(contents == static_cast<std::string>(sv));
+	std::fclose(file);
+}
+
+TEST_CASE("write_to_fd - reports errors") {
+	CHECK_THROWS_AS(fsv::write_to_fd(-1, fsv::filtered_string_view{"abc"}), std::system_error);
+}
+
+TEST_CASE("Identity - unfiltered views agree with filtered ones") {
+	const auto keep_all = [](const char&) { return true; };
+	auto base = std::string(200, 'm');
+	auto strings = std::vector<std::string>{"", "m", base, base + "a", base + "\xff", base + "\x01"};
+	strings.push_back(base.substr(0, 70) + "\x80" + base.substr(71));
+	for (const auto& lhs : strings) {
+		for (const auto& rhs : strings) {
+			const auto identity = fsv::filtered_string_view{lhs} <=> fsv::filtered_string_view{rhs};
+			const auto filtered = fsv::filtered_string_view{lhs, keep_all} <=> fsv::filtered_string_view{rhs, keep_all};
+			CHECK(identity == filtered);
+			CHECK((fsv::filtered_string_view{lhs} == fsv::filtered_string_view{rhs}) == (lhs == rhs));
+		}
+	}
+}
+
+TEST_CASE("Identity - slices, conversions and output") {
+	const auto str = std::string{"unfiltered slice of a buffer"};
+	const auto sv = fsv::filtered_string_view{str.data() + 11, 5};
+	CHECK(sv.size() == 5);
+	CHECK(!sv.empty());
+	CHECK(sv[std::size_t{4}] == 'e');
+	CHECK(static_cast<std::string>(sv) == "slice");
+	auto out = std::ostringstream{};
+	out << sv;
+	CHECK(out.str() == "slice");
+	CHECK(sv == fsv::filtered_string_view{"slice"});
+
+	const auto all = fsv::filtered_string_view{str, fsv::pure_filter{fsv::byte_set::all()}};
+	CHECK(all.size() == str.size());
+	auto moved_from = fsv::filtered_string_view{str, [](const char& c) { return c == 'u'; }};
+	const auto moved_to = std::move(moved_from);
+	CHECK(moved_to.size() == 2);
+	CHECK(moved_from.size() == 0);
+	CHECK(moved_from.empty());
+}
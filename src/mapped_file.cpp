@@ -0,0 +1,132 @@
+#include "./mapped_file.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+	[[noreturn]] auto fail(const std::string& what, const std::string& path) -> void {
+		throw std::system_error{errno, std::generic_category(), "fsv::mapped_file: " + what + " " + path};
+	}
+} // namespace
+
+// Constructor
+fsv::mapped_file::mapped_file(const std::string& path)
+: data_{nullptr}
+, size_{0} {
+	const auto fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+	if (fd < 0) {
+		fail("cannot open", path);
+	}
+	struct stat status {};
+	if (::fstat(fd, &status) != 0) {
+		const auto error = errno;
+		::close(fd);
+		errno = error;
+		fail("cannot stat", path);
+	}
+	size_ = static_cast<std::size_t>(status.st_size);
+
+	// A zero-length mapping is an error, and an empty file needs no bytes anyway.
+	if (size_ == 0) {
+		::close(fd);
+		return;
+	}
+
+	auto flags = MAP_PRIVATE;
+#ifdef MAP_POPULATE
+	// Fault every page in up front, so the first scan is not a stream of page faults.
+	flags |= MAP_POPULATE;
+#endif
+	auto* mapping = ::mmap(nullptr, size_, PROT_READ, flags, fd, 0);
+	const auto error = errno;
+	// The mapping keeps its own reference to the file.
+	::close(fd);
+	if (mapping == MAP_FAILED) {
+		errno = error;
+		fail("cannot map", path);
+	}
+	// Views are scanned front to back, so ask for aggressive read-ahead. This is only a hint.
+	::madvise(mapping, size_, MADV_SEQUENTIAL);
+	data_ = static_cast<const char*>(mapping);
+}
+
+// Move Constructor
+fsv::mapped_file::mapped_file(mapped_file&& other) noexcept
+: data_{std::exchange(other.data_, nullptr)}
+, size_{std::exchange(other.size_, 0)} {}
+
+// Destructor
+fsv::mapped_file::~mapped_file() noexcept {
+	if (data_ != nullptr) {
+		::munmap(const_cast<char*>(data_), size_);
+	}
+}
+
+// Move Assignment
+auto fsv::mapped_file::operator=(mapped_file&& other) noexcept -> mapped_file& {
+	if (this != &other) {
+		if (data_ != nullptr) {
+			::munmap(const_cast<char*>(data_), size_);
+		}
+		data_ = std::exchange(other.data_, nullptr);
+		size_ = std::exchange(other.size_, 0);
+	}
+	return *this;
+}
+
+// Member Function - data
+auto fsv::mapped_file::data() const noexcept -> const char* {
+	return data_;
+}
+
+// Member Function - size
+auto fsv::mapped_file::size() const noexcept -> std::size_t {
+	return size_;
+}
+
+// Member Function - view
+auto fsv::mapped_file::view() const noexcept -> filtered_string_view {
+	return filtered_string_view{data_, size_};
+}
+
+// Member Function - view with Predicate
+auto fsv::mapped_file::view(filter predicate) const noexcept -> filtered_string_view {
+	return filtered_string_view{data_, size_, std::move(predicate)};
+}
+
+// Member Function - view with Pure Predicate
+auto fsv::mapped_file::view(pure_filter predicate) const noexcept -> filtered_string_view {
+	return filtered_string_view{data_, size_, predicate};
+}
+
+// Member Function - view of a Byte Range
+auto fsv::mapped_file::view(std::size_t offset, std::size_t count) const noexcept -> filtered_string_view {
+	offset = std::min(offset, size_);
+	return filtered_string_view{data_ + offset, clamp(offset, count)};
+}
+
+// Member Function - view of a Byte Range with Predicate
+auto fsv::mapped_file::view(std::size_t offset, std::size_t count, filter predicate) const noexcept
+    -> filtered_string_view {
+	offset = std::min(offset, size_);
+	return filtered_string_view{data_ + offset, clamp(offset, count), std::move(predicate)};
+}
+
+// Member Function - view of a Byte Range with Pure Predicate
+auto fsv::mapped_file::view(std::size_t offset, std::size_t count, pure_filter predicate) const noexcept
+    -> filtered_string_view {
+	offset = std::min(offset, size_);
+	return filtered_string_view{data_ + offset, clamp(offset, count), predicate};
+}
+
+// helper function - clamp
+auto fsv::mapped_file::clamp(std::size_t offset, std::size_t count) const noexcept -> std::size_t {
+	return std::min(count, size_ - offset);
+}
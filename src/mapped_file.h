@@ -0,0 +1,53 @@
+#ifndef COMP6771_ASS2_MAPPED_FILE_H
+#define COMP6771_ASS2_MAPPED_FILE_H
+
+#include <cstddef>
+#include <string>
+
+#include "./filtered_string_view.h"
+
+namespace fsv {
+	/**
+	 * A whole file mapped read-only into memory, and the owner of the bytes that views made
+	 * from it present. The file is never copied into a std::string: pages are faulted in by
+	 * the kernel, ahead of use where the platform supports it.
+	 *
+	 * Views borrow the mapping the way they borrow a std::string, so the mapped_file must
+	 * outlive every view made from it.
+	 */
+	class mapped_file {
+	 public:
+		// Maps the file at path. Throws std::system_error if it cannot be opened or mapped.
+		explicit mapped_file(const std::string& path);
+
+		mapped_file(const mapped_file& other) = delete;
+		mapped_file(mapped_file&& other) noexcept;
+		~mapped_file() noexcept;
+
+		auto operator=(const mapped_file& other) -> mapped_file& = delete;
+		auto operator=(mapped_file&& other) noexcept -> mapped_file&;
+
+		[[nodiscard]] auto data() const noexcept -> const char*;
+		[[nodiscard]] auto size() const noexcept -> std::size_t;
+
+		// Views over the whole file
+		[[nodiscard]] auto view() const noexcept -> filtered_string_view;
+		[[nodiscard]] auto view(filter predicate) const noexcept -> filtered_string_view;
+		[[nodiscard]] auto view(pure_filter predicate) const noexcept -> filtered_string_view;
+
+		// Views over the bytes [offset, offset + count) of the file, clamped to its end
+		[[nodiscard]] auto view(std::size_t offset, std::size_t count) const noexcept -> filtered_string_view;
+		[[nodiscard]] auto view(std::size_t offset, std::size_t count, filter predicate) const noexcept
+		    -> filtered_string_view;
+		[[nodiscard]] auto view(std::size_t offset, std::size_t count, pure_filter predicate) const noexcept
+		    -> filtered_string_view;
+
+	 private:
+		const char* data_;
+		std::size_t size_;
+
+		[[nodiscard]] auto clamp(std::size_t offset, std::size_t count) const noexcept -> std::size_t;
+	};
+} // namespace fsv
+
+#endif // COMP6771_ASS2_MAPPED_FILE_H
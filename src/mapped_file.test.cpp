@@ -0,0 +1,86 @@
+#include "./mapped_file.h"
+
+#include <catch2/catch.hpp>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <system_error>
+#include <unistd.h>
+
+namespace {
+	// A file in the temporary directory holding contents, removed when it goes out of scope
+	class temp_file {
+	 public:
+		explicit temp_file(const std::string& contents)
+		: path_{"/tmp/fsv_mapped_file_test_" + std::to_string(::getpid()) + "_" + std::to_string(counter_++)} {
+			auto out = std::ofstream{path_, std::ios::binary};
+			out.write(contents.data(), static_cast<std::streamsize>(contents.size()));
+		}
+		temp_file(const temp_file&) = delete;
+		auto operator=(const temp_file&) -> temp_file& = delete;
+		~temp_file() {
+			std::remove(path_.c_str());
+		}
+
+		[[nodiscard]] auto path() const -> const std::string& {
+			return path_;
+		}
+
+	 private:
+		static inline auto counter_ = 0;
+		std::string path_;
+	};
+} // namespace
+
+TEST_CASE("Mapped File - views over the whole file") {
+	const auto file = temp_file{"GET /index.html\r\nHost: example.com\r\n"};
+	const auto mapped = fsv::mapped_file{file.path()};
+	CHECK(mapped.size() == 36);
+	CHECK(mapped.view() == "GET /index.html\r\nHost: example.com\r\n");
+	CHECK(mapped.view().data() == mapped.data());
+	CHECK(mapped.view([](const char& c) { return c != '\r'; }) == "GET /index.html\nHost: example.com\n");
+	const auto no_space = mapped.view(fsv::pure_filter{[](const char& c) { return c != ' '; }});
+	CHECK(no_space.table().has_value());
+	CHECK(no_space.size() == 34);
+}
+
+TEST_CASE("Mapped File - views over byte ranges") {
+	const auto file = temp_file{"header|a-b-c|trailer"};
+	const auto mapped = fsv::mapped_file{file.path()};
+	CHECK(mapped.view(7, 5) == "a-b-c");
+	CHECK(mapped.view(7, 5, [](const char& c) { return c != '-'; }) == "abc");
+	CHECK(mapped.view(7, 5, fsv::pure_filter{[](const char& c) { return c == '-'; }}) == "--");
+	CHECK(mapped.view(13, 100) == "trailer");
+	CHECK(mapped.view(100, 5).empty());
+}
+
+TEST_CASE("Mapped File - contents are not NUL-terminated") {
+	const auto file = temp_file{std::string{"ab\0cd", 5}};
+	const auto mapped = fsv::mapped_file{file.path()};
+	CHECK(mapped.view().size() == 5);
+	CHECK(mapped.view([](const char& c) { return c != '\0'; }) == "abcd");
+}
+
+TEST_CASE("Mapped File - empty file") {
+	const auto file = temp_file{""};
+	const auto mapped = fsv::mapped_file{file.path()};
+	CHECK(mapped.size() == 0);
+	CHECK(mapped.view().empty());
+	CHECK(mapped.view(0, 10).empty());
+}
+
+TEST_CASE("Mapped File - move transfers the mapping") {
+	const auto file = temp_file{"moved"};
+	auto first = fsv::mapped_file{file.path()};
+	const auto* data = first.data();
+	auto second = std::move(first);
+	CHECK(second.data() == data);
+	CHECK(first.data() == nullptr);
+	CHECK(first.size() == 0);
+	first = std::move(second);
+	CHECK(first.view() == "moved");
+}
+
+TEST_CASE("Mapped File - missing file") {
+	CHECK_THROWS_AS(fsv::mapped_file{"/nonexistent/fsv_mapped_file_test"}, std::system_error);
+}
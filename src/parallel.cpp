@@ -0,0 +1,226 @@
+#include "./parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "./byte_kernels.h"
+
+namespace fsv::detail {
+	/**
+	 * The raw range of a view cut into cache-line-aligned chunks, and a team of threads that
+	 * work through them. Each thread owns a contiguous share of the chunks and takes them from
+	 * the front; once its share is used up it steals from the front of the other shares.
+	 */
+	class parallel_scan {
+	 public:
+		parallel_scan(const filtered_string_view& fsv, const parallel::options& opts) noexcept
+		: fsv_{fsv}
+		, raw_size_{fsv.raw_size()}
+		, chunk_bytes_{std::max((opts.chunk_bytes + cache_line - 1) / cache_line * cache_line, cache_line)}
+		, misalignment_{reinterpret_cast<std::uintptr_t>(fsv.first_) % cache_line}
+		, chunks_{(raw_size_ + misalignment_ + chunk_bytes_ - 1) / chunk_bytes_}
+		, threads_{std::clamp(opts.threads != 0 ? opts.threads : std::size_t{std::thread::hardware_concurrency()},
+		                      std::size_t{1},
+		                      std::max(chunks_, std::size_t{1}))}
+		, sequential_{raw_size_ < opts.threshold or threads_ == 1} {}
+
+		[[nodiscard]] auto sequential() const noexcept -> bool {
+			return sequential_;
+		}
+
+		// Whether the view has a built index, which answers size() and empty() without a scan. An
+		// index that is enabled but not yet built is left alone, as building it is a serial scan.
+		[[nodiscard]] auto indexed() const noexcept -> bool {
+			return fsv_.ready_index() != nullptr;
+		}
+
+		[[nodiscard]] auto table() const noexcept -> const std::optional<byte_set>& {
+			return fsv_.table_;
+		}
+
+		[[nodiscard]] auto predicate() const noexcept -> const filter& {
+			return *fsv_.predicate_;
+		}
+
+		[[nodiscard]] auto chunks() const noexcept -> std::size_t {
+			return chunks_;
+		}
+
+		/**
+		 * Calls fn(chunk, first, count) once for every chunk, across the team.
+		 *
+		 * @param fn Called with a chunk's number and raw bytes; may set stop to end the scan early.
+		 */
+		template<typename Fn>
+		auto run(const Fn& fn, std::atomic<bool>& stop) const -> void {
+			struct alignas(cache_line) share {
+				std::atomic<std::size_t> next;
+				std::size_t last;
+			};
+			auto shares = std::make_unique<share[]>(threads_);
+			for (auto t = std::size_t{0}; t < threads_; ++t) {
+				shares[t].next.store(chunks_ * t / threads_, std::memory_order_relaxed);
+				shares[t].last = chunks_ * (t + 1) / threads_;
+			}
+
+			const auto work = [&](std::size_t self) {
+				for (auto offset = std::size_t{0}; offset < threads_; ++offset) {
+					auto& victim = shares[(self + offset) % threads_];
+					while (not stop.load(std::memory_order_relaxed)) {
+						const auto chunk = victim.next.fetch_add(1, std::memory_order_relaxed);
+						if (chunk >= victim.last) {
+							break;
+						}
+						const auto first = edge(chunk);
+						fn(chunk, fsv_.first_ + first, edge(chunk + 1) - first);
+					}
+				}
+			};
+
+			auto team = std::vector<std::jthread>{};
+			team.reserve(threads_ - 1);
+			for (auto t = std::size_t{1}; t < threads_; ++t) {
+				team.emplace_back(work, t);
+			}
+			work(0);
+		}
+
+		// fn(first, count) for every chunk, each result kept in its chunk's slot
+		template<typename Fn>
+		auto per_chunk(const Fn& fn, std::atomic<bool>& stop) const -> std::vector<std::size_t> {
+			auto results = std::vector<std::size_t>(chunks_, 0);
+			run([&](std::size_t chunk, const char* first, std::size_t count) { results[chunk] = fn(first, count); },
+			    stop);
+			return results;
+		}
+
+		// The sum of fn(first, count) over every chunk
+		template<typename Fn>
+		auto sum(const Fn& fn, std::atomic<bool>& stop) const -> std::size_t {
+			const auto results = per_chunk(fn, stop);
+			return std::accumulate(results.begin(), results.end(), std::size_t{0});
+		}
+
+	 private:
+		static constexpr auto cache_line = std::size_t{64};
+
+		const filtered_string_view& fsv_;
+		std::size_t raw_size_;
+		std::size_t chunk_bytes_;
+		std::size_t misalignment_;
+		std::size_t chunks_;
+		std::size_t threads_;
+		bool sequential_;
+
+		// Raw offset where chunk starts; every edge but the first and last is on a cache line.
+		[[nodiscard]] auto edge(std::size_t chunk) const noexcept -> std::size_t {
+			return chunk == 0 ? 0 : std::min(chunk * chunk_bytes_ - misalignment_, raw_size_);
+		}
+	};
+} // namespace fsv::detail
+
+// Parallel - size
+auto fsv::parallel::size(const filtered_string_view& fsv, const options& opts) -> std::size_t {
+	const auto scan = detail::parallel_scan{fsv, opts};
+	if (scan.sequential() or scan.indexed() or scan.table() == byte_set::all()) {
+		return fsv.size();
+	}
+	auto stop = std::atomic<bool>{false};
+	if (const auto& table = scan.table(); table.has_value()) {
+		return scan.sum(
+		    [&table](const char* first, std::size_t count) { return detail::count_in_set(first, count, *table); },
+		    stop);
+	}
+	return scan.sum(
+	    [&predicate = scan.predicate()](const char* first, std::size_t count) {
+		    return static_cast<std::size_t>(std::count_if(first, first + count, std::cref(predicate)));
+	    },
+	    stop);
+}
+
+// Parallel - count_if
+auto fsv::parallel::count_if(const filtered_string_view& fsv, const filter& predicate, const options& opts)
+    -> std::size_t {
+	const auto scan = detail::parallel_scan{fsv, opts};
+	if (scan.sequential()) {
+		return static_cast<std::size_t>(std::count_if(fsv.begin(), fsv.end(), std::cref(predicate)));
+	}
+	auto stop = std::atomic<bool>{false};
+	const auto* pure = predicate.target<pure_filter>();
+	if (const auto& table = scan.table(); table.has_value() and pure != nullptr) {
+		// Both sides are tables, so the whole test is one table.
+		const auto both = *table & pure->table();
+		return scan.sum(
+		    [&both](const char* first, std::size_t count) { return detail::count_in_set(first, count, both); },
+		    stop);
+	}
+	return scan.sum(
+	    [&keep = scan.predicate(), &predicate](const char* first, std::size_t count) {
+		    return static_cast<std::size_t>(
+		        std::count_if(first, first + count, [&](const char& c) { return keep(c) and predicate(c); }));
+	    },
+	    stop);
+}
+
+// Parallel - empty
+auto fsv::parallel::empty(const filtered_string_view& fsv, const options& opts) -> bool {
+	const auto scan = detail::parallel_scan{fsv, opts};
+	if (scan.sequential() or scan.indexed()) {
+		return fsv.empty();
+	}
+	auto stop = std::atomic<bool>{false};
+	const auto& table = scan.table();
+	const auto& predicate = scan.predicate();
+	const auto found = scan.sum(
+	    [&](const char* first, std::size_t count) -> std::size_t {
+		    const auto any = table.has_value() ? detail::find_in_set(first, count, *table) != count
+		                                       : std::any_of(first, first + count, std::cref(predicate));
+		    if (any) {
+			    stop.store(true, std::memory_order_relaxed);
+		    }
+		    return any ? 1 : 0;
+	    },
+	    stop);
+	return found == 0;
+}
+
+// Parallel - materialize
+auto fsv::parallel::materialize(const filtered_string_view& fsv, const options& opts) -> std::string {
+	const auto scan = detail::parallel_scan{fsv, opts};
+	if (scan.sequential()) {
+		return static_cast<std::string>(fsv);
+	}
+	const auto& table = scan.table();
+	const auto& predicate = scan.predicate();
+	auto stop = std::atomic<bool>{false};
+
+	// Pass one: how many bytes each chunk keeps, and from that where each chunk's output starts.
+	const auto counts = scan.per_chunk(
+	    [&](const char* first, std::size_t count) {
+		    return table.has_value() ? detail::count_in_set(first, count, *table)
+		                             : static_cast<std::size_t>(std::count_if(first, first + count, std::cref(predicate)));
+	    },
+	    stop);
+	auto offsets = std::vector<std::size_t>(counts.size(), 0);
+	std::exclusive_scan(counts.begin(), counts.end(), offsets.begin(), std::size_t{0});
+
+	// Pass two: every chunk compacts into its own slot of the one allocation.
+	auto materialized = std::string(counts.empty() ? 0 : offsets.back() + counts.back(), '\0');
+	scan.run(
+	    [&](std::size_t chunk, const char* first, std::size_t count) {
+		    auto* out = materialized.data() + offsets[chunk];
+		    if (table.has_value()) {
+			    detail::compact_in_set(first, count, *table, out, counts[chunk]);
+		    }
+		    else {
+			    std::copy_if(first, first + count, out, std::cref(predicate));
+		    }
+	    },
+	    stop);
+	return materialized;
+}
@@ -0,0 +1,44 @@
+#ifndef COMP6771_ASS2_PARALLEL_H
+#define COMP6771_ASS2_PARALLEL_H
+
+#include <cstddef>
+#include <string>
+
+#include "./filtered_string_view.h"
+
+namespace fsv::parallel {
+	// How a view is divided between threads
+	struct options {
+		// Views with fewer raw bytes than this are scanned on the calling thread.
+		std::size_t threshold = std::size_t{4} << 20U;
+		// Threads to scan with, including the calling thread; 0 means one per hardware thread.
+		std::size_t threads = 0;
+		// Raw bytes per unit of work. Chunk edges fall on cache line boundaries.
+		std::size_t chunk_bytes = std::size_t{256} << 10U;
+	};
+
+	/**
+	 * Parallel equivalents of fsv.size(), std::count_if over fsv and fsv.empty().
+	 *
+	 * The raw range is split into chunks that each thread takes from its own share, stealing
+	 * from the other threads' shares once its own runs out, so an uneven split still finishes
+	 * together. Predicates are called from several threads at once and must be safe for that.
+	 */
+	[[nodiscard]] auto size(const filtered_string_view& fsv, const options& opts = {}) -> std::size_t;
+
+	// The number of kept chars c for which predicate(c) is true
+	[[nodiscard]] auto count_if(const filtered_string_view& fsv, const filter& predicate, const options& opts = {})
+	    -> std::size_t;
+
+	// Stops every thread as soon as any of them finds a kept char.
+	[[nodiscard]] auto empty(const filtered_string_view& fsv, const options& opts = {}) -> bool;
+
+	/**
+	 * static_cast<std::string>(fsv), built by two-pass stream compaction: every chunk's kept
+	 * bytes are counted in parallel, an exclusive prefix sum of the counts gives each chunk its
+	 * offset in the one allocation, and every chunk is then compacted into its own slot.
+	 */
+	[[nodiscard]] auto materialize(const filtered_string_view& fsv, const options& opts = {}) -> std::string;
+} // namespace fsv::parallel
+
+#endif // COMP6771_ASS2_PARALLEL_H
@@ -0,0 +1,114 @@
+#include "./parallel.h"
+
+#include <algorithm>
+#include <atomic>
+#include <catch2/catch.hpp>
+#include <string>
+#include <vector>
+
+namespace {
+	auto make_text(std::size_t size) -> std::string {
+		auto text = std::string(size, '\0');
+		auto state = std::uint32_t{2024};
+		for (auto& c : text) {
+			state = state * 1103515245U + 12345U;
+			c = static_cast<char>('a' + (state >> 16U) % 26U);
+		}
+		return text;
+	}
+
+	auto is_vowel(const char& c) -> bool {
+		return c == 'a' || c == 'e' || c == 'i' || c == 'o' || c == 'u';
+	}
+
+	// Small chunks and no threshold, so even short test inputs are split between threads
+	auto forced(std::size_t threads) -> fsv::parallel::options {
+		return {.threshold = 0, .threads = threads, .chunk_bytes = 100};
+	}
+} // namespace
+
+TEST_CASE("Parallel - size matches size()") {
+	const auto text = make_text(100000);
+	for (const auto& sv : {fsv::filtered_string_view{text},
+	                       fsv::filtered_string_view{text, is_vowel},
+	                       fsv::filtered_string_view{text, fsv::pure_filter{is_vowel}},
+	                       fsv::filtered_string_view{text.data() + 3, 50001, is_vowel}})
+	{
+		for (const auto threads : {std::size_t{1}, std::size_t{2}, std::size_t{7}, std::size_t{32}}) {
+			CHECK(fsv::parallel::size(sv, forced(threads)) == sv.size());
+		}
+		CHECK(fsv::parallel::size(sv) == sv.size());
+	}
+}
+
+TEST_CASE("Parallel - count_if matches std::count_if") {
+	const auto text = make_text(50000);
+	const auto is_early = [](const char& c) { return c < 'h'; };
+	for (const auto& sv :
+	     {fsv::filtered_string_view{text, is_vowel}, fsv::filtered_string_view{text, fsv::pure_filter{is_vowel}}})
+	{
+		const auto expected = static_cast<std::size_t>(std::count_if(sv.begin(), sv.end(), is_early));
+		CHECK(fsv::parallel::count_if(sv, is_early, forced(4)) == expected);
+		CHECK(fsv::parallel::count_if(sv, fsv::pure_filter{is_early}, forced(4)) == expected);
+		CHECK(fsv::parallel::count_if(sv, is_early) == expected);
+	}
+}
+
+TEST_CASE("Parallel - empty stops at any kept char") {
+	auto text = std::string(200000, 'x');
+	const auto is_digit = fsv::pure_filter{[](const char& c) { return c >= '0' && c <= '9'; }};
+	CHECK(fsv::parallel::empty(fsv::filtered_string_view{text, is_digit}, forced(4)));
+	for (const auto position : {std::size_t{0}, std::size_t{12345}, std::size_t{199999}}) {
+		text[position] = '5';
+		CHECK(!fsv::parallel::empty(fsv::filtered_string_view{text, is_digit}, forced(4)));
+		CHECK(!fsv::parallel::empty(fsv::filtered_string_view{text, [](const char& c) { return c == '5'; }}, forced(3)));
+		text[position] = 'x';
+	}
+	CHECK(fsv::parallel::empty(fsv::filtered_string_view{}, forced(4)));
+}
+
+TEST_CASE("Parallel - indexed views answer from the index") {
+	const auto text = make_text(10000);
+	auto sv = fsv::filtered_string_view{text, is_vowel};
+	sv.enable_index();
+	CHECK(fsv::parallel::size(sv, forced(4)) == sv.size());
+	CHECK(!fsv::parallel::empty(sv, forced(4)));
+}
+
+TEST_CASE("Parallel - an enabled but unbuilt index is not built serially") {
+	const auto text = make_text(10000);
+	auto calls = std::atomic<std::size_t>{0};
+	auto sv = fsv::filtered_string_view{text, [&calls](const char& c) {
+		                                    calls.fetch_add(1, std::memory_order_relaxed);
+		                                    return is_vowel(c);
+	                                    }};
+	sv.enable_index();
+	const auto expected = static_cast<std::size_t>(std::count_if(text.begin(), text.end(), is_vowel));
+	CHECK(fsv::parallel::size(sv, forced(4)) == expected);
+	// The first size() is the one that builds the index, so it calls the predicate on every byte.
+	calls = 0;
+	CHECK(sv.size() == expected);
+	CHECK(calls == text.size());
+
+	// Once built, the index answers without calling the predicate at all.
+	calls = 0;
+	CHECK(fsv::parallel::size(sv, forced(4)) == expected);
+	CHECK(calls == 0);
+}
+
+TEST_CASE("Parallel - materialize matches the string conversion") {
+	const auto text = make_text(100000);
+	for (const auto& sv : {fsv::filtered_string_view{text},
+	                       fsv::filtered_string_view{text, is_vowel},
+	                       fsv::filtered_string_view{text, fsv::pure_filter{is_vowel}},
+	                       fsv::filtered_string_view{text.data() + 5, 777, fsv::pure_filter{is_vowel}},
+	                       fsv::filtered_string_view{text, [](const char&) { return false; }}})
+	{
+		const auto expected = static_cast<std::string>(sv);
+		for (const auto threads : {std::size_t{1}, std::size_t{3}, std::size_t{8}}) {
+			CHECK(fsv::parallel::materialize(sv, forced(threads)) == expected);
+		}
+		CHECK(fsv::parallel::materialize(sv) == expected);
+	}
+	CHECK(fsv::parallel::materialize(fsv::filtered_string_view{}, forced(4)).empty());
+}
@@ -0,0 +1,153 @@
+#include "./pattern_set.h"
+
+#include <stdexcept>
+#include <utility>
+
+// Pattern Set - Constructor
+fsv::pattern_set::pattern_set(std::vector<std::string> patterns)
+: patterns_{std::move(patterns)}
+, columns_{}
+, stride_{1}
+, transitions_{}
+, matches_{}
+, match_patterns_{} {
+	// Column 0 is shared by every byte that occurs in no pattern.
+	for (const auto& pattern : patterns_) {
+		if (pattern.empty()) {
+			throw std::invalid_argument{"fsv::pattern_set: empty pattern"};
+		}
+		for (const auto c : pattern) {
+			auto& column = columns_[static_cast<unsigned char>(c)];
+			if (column == 0) {
+				column = static_cast<std::uint16_t>(stride_++);
+			}
+		}
+	}
+
+	// The trie first, where 0 marks a missing edge, as no edge leads back to the root.
+	auto own = std::vector<std::vector<std::uint32_t>>(1);
+	transitions_.assign(stride_, 0);
+	for (auto p = std::size_t{0}; p < patterns_.size(); ++p) {
+		auto state = std::size_t{0};
+		for (const auto c : patterns_[p]) {
+			const auto edge = state * stride_ + columns_[static_cast<unsigned char>(c)];
+			if (transitions_[edge] == 0) {
+				if ((own.size() + 1) * stride_ >= ends_match) {
+					throw std::length_error{"fsv::pattern_set: too many states"};
+				}
+				transitions_[edge] = static_cast<std::uint32_t>(own.size());
+				own.emplace_back();
+				transitions_.resize(transitions_.size() + stride_, 0);
+			}
+			state = transitions_[edge];
+		}
+		own[state].push_back(static_cast<std::uint32_t>(p));
+	}
+
+	// Then breadth first, so a state's suffix link and row are complete before any deeper state
+	// uses them: every missing edge becomes the edge its suffix link takes.
+	auto suffix = std::vector<std::uint32_t>(own.size(), 0);
+	auto order = std::vector<std::uint32_t>{0};
+	order.reserve(own.size());
+	for (auto i = std::size_t{0}; i < order.size(); ++i) {
+		const auto state = order[i];
+		for (auto column = std::size_t{0}; column < stride_; ++column) {
+			const auto edge = state * stride_ + column;
+			const auto fallback = state == 0 ? 0 : transitions_[suffix[state] * stride_ + column];
+			if (transitions_[edge] != 0) {
+				suffix[transitions_[edge]] = fallback;
+				order.push_back(transitions_[edge]);
+			}
+			else {
+				transitions_[edge] = fallback;
+			}
+		}
+	}
+
+	matches_.resize(own.size());
+	for (const auto state : order) {
+		auto& matches = matches_[state];
+		matches.first = static_cast<std::uint32_t>(match_patterns_.size());
+		matches.own = static_cast<std::uint32_t>(own[state].size());
+		match_patterns_.insert(match_patterns_.end(), own[state].begin(), own[state].end());
+		if (state == 0) {
+			matches.link = no_link;
+		}
+		else {
+			const auto shorter = suffix[state];
+			matches.link = own[shorter].empty() ? matches_[shorter].link : shorter;
+		}
+		matches.total = matches.own + (matches.link == no_link ? 0 : matches_[matches.link].total);
+	}
+
+	// Finally every edge becomes the offset of its target's row, flagged if the target ends a match.
+	for (auto& target : transitions_) {
+		target = (target * stride_) | (matches_[target].total != 0 ? ends_match : 0);
+	}
+}
+
+// helper function - scan
+template<typename OnMatch>
+auto fsv::pattern_set::scan(const filtered_string_view& fsv, OnMatch&& on_match) const -> void {
+	// One automaton runs across every kept run, as the runs are adjacent in filtered space.
+	auto row = std::uint32_t{0};
+	auto offset = std::size_t{0};
+	for (const auto run : fsv.chunks()) {
+		for (auto i = std::size_t{0}; i < run.size(); ++i) {
+			const auto next = transitions_[row + columns_[static_cast<unsigned char>(run[i])]];
+			row = next & ~ends_match;
+			if ((next & ends_match) != 0 and not on_match(row / stride_, offset + i)) {
+				return;
+			}
+		}
+		offset += run.size();
+	}
+}
+
+// Pattern Set - patterns
+auto fsv::pattern_set::patterns() const noexcept -> const std::vector<std::string>& {
+	return patterns_;
+}
+
+// Pattern Set - states
+auto fsv::pattern_set::states() const noexcept -> std::size_t {
+	return matches_.size();
+}
+
+// Pattern Set - find_all
+auto fsv::pattern_set::find_all(const filtered_string_view& fsv) const -> std::vector<pattern_match> {
+	auto found = std::vector<pattern_match>{};
+	scan(fsv, [this, &found](std::uint32_t state, std::size_t end) {
+		for (auto s = state; s != no_link; s = matches_[s].link) {
+			const auto& matches = matches_[s];
+			for (auto k = matches.first; k != matches.first + matches.own; ++k) {
+				const auto pattern = std::size_t{match_patterns_[k]};
+				found.push_back({pattern, end + 1 - patterns_[pattern].size()});
+			}
+		}
+		return true;
+	});
+	return found;
+}
+
+// Pattern Set - find_first
+auto fsv::pattern_set::find_first(const filtered_string_view& fsv) const -> std::optional<pattern_match> {
+	auto found = std::optional<pattern_match>{};
+	scan(fsv, [this, &found](std::uint32_t state, std::size_t end) {
+		const auto longest = matches_[state].own != 0 ? state : matches_[state].link;
+		const auto pattern = std::size_t{match_patterns_[matches_[longest].first]};
+		found = pattern_match{pattern, end + 1 - patterns_[pattern].size()};
+		return false;
+	});
+	return found;
+}
+
+// Pattern Set - count
+auto fsv::pattern_set::count(const filtered_string_view& fsv) const -> std::size_t {
+	auto total = std::size_t{0};
+	scan(fsv, [this, &total](std::uint32_t state, std::size_t) {
+		total += matches_[state].total;
+		return true;
+	});
+	return total;
+}
@@ -0,0 +1,80 @@
+#ifndef COMP6771_ASS2_PATTERN_SET_H
+#define COMP6771_ASS2_PATTERN_SET_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "./filtered_string_view.h"
+
+namespace fsv {
+	// An occurrence of patterns()[pattern] starting at kept char pos of the view searched
+	struct pattern_match {
+		std::size_t pattern;
+		std::size_t pos;
+
+		friend auto operator==(const pattern_match&, const pattern_match&) -> bool = default;
+	};
+
+	/**
+	 * Many patterns compiled once into an Aho-Corasick automaton, then matched against the kept
+	 * chars of any number of views in a single pass each, however many patterns there are.
+	 *
+	 * The automaton is a complete DFA in one flat table. Bytes that occur in no pattern share a
+	 * column, so a row is only as wide as the patterns' alphabet, and each entry is the offset of
+	 * the next state's row with a flag bit set when that state ends a match. Scanning a byte is
+	 * one load, and only flagged states ever look further. The view's kept runs are scanned with
+	 * the automaton's state carried across them, so matches are found across filtered-out bytes.
+	 */
+	class pattern_set {
+	 public:
+		/**
+		 * @throws std::invalid_argument if any pattern is empty.
+		 * @throws std::length_error if the automaton would need more than 2^31 table entries.
+		 */
+		explicit pattern_set(std::vector<std::string> patterns);
+
+		[[nodiscard]] auto patterns() const noexcept -> const std::vector<std::string>&;
+		[[nodiscard]] auto states() const noexcept -> std::size_t;
+
+		/**
+		 * Every occurrence of every pattern in fsv, overlaps included, ordered by the kept char
+		 * they end at and, among those ending together, longest first.
+		 */
+		[[nodiscard]] auto find_all(const filtered_string_view& fsv) const -> std::vector<pattern_match>;
+
+		// The occurrence that ends first, the longest if several do, found without scanning further
+		[[nodiscard]] auto find_first(const filtered_string_view& fsv) const -> std::optional<pattern_match>;
+
+		// find_all(fsv).size(), without collecting the matches
+		[[nodiscard]] auto count(const filtered_string_view& fsv) const -> std::size_t;
+
+	 private:
+		// The matches ending at a state: its own patterns, then those of the longest proper
+		// suffix state that has any, and so on down the chain of links.
+		struct state_matches {
+			std::uint32_t first;
+			std::uint32_t own;
+			std::uint32_t link;
+			std::uint32_t total;
+		};
+
+		static constexpr auto no_link = ~std::uint32_t{0};
+		static constexpr auto ends_match = std::uint32_t{1} << 31U;
+
+		std::vector<std::string> patterns_;
+		std::array<std::uint16_t, 256> columns_;
+		std::uint32_t stride_;
+		std::vector<std::uint32_t> transitions_;
+		std::vector<state_matches> matches_;
+		std::vector<std::uint32_t> match_patterns_;
+
+		template<typename OnMatch>
+		auto scan(const filtered_string_view& fsv, OnMatch&& on_match) const -> void;
+	};
+} // namespace fsv
+
+#endif // COMP6771_ASS2_PATTERN_SET_H
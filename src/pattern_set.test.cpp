@@ -0,0 +1,80 @@
+#include "./pattern_set.h"
+
+#include <catch2/catch.hpp>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+namespace {
+	// Every occurrence of every pattern, found by std::string::find, in pattern_set's order
+	auto brute_force(const std::string& text, const std::vector<std::string>& patterns)
+	    -> std::vector<fsv::pattern_match> {
+		auto found = std::vector<fsv::pattern_match>{};
+		for (auto p = std::size_t{0}; p < patterns.size(); ++p) {
+			for (auto pos = text.find(patterns[p]); pos != std::string::npos; pos = text.find(patterns[p], pos + 1)) {
+				found.push_back({p, pos});
+			}
+		}
+		std::ranges::sort(found, [&patterns](const fsv::pattern_match& lhs, const fsv::pattern_match& rhs) {
+			const auto lhs_end = lhs.pos + patterns[lhs.pattern].size();
+			const auto rhs_end = rhs.pos + patterns[rhs.pattern].size();
+			if (lhs_end != rhs_end) {
+				return lhs_end < rhs_end;
+			}
+			if (lhs.pos != rhs.pos) {
+				return lhs.pos < rhs.pos;
+			}
+			return lhs.pattern < rhs.pattern;
+		});
+		return found;
+	}
+} // namespace
+
+TEST_CASE("Pattern Set - overlapping matches in one pass") {
+	const auto set = fsv::pattern_set{{"he", "she", "his", "hers"}};
+	const auto found = set.find_all(fsv::filtered_string_view{"ushers"});
+	CHECK(found == std::vector<fsv::pattern_match>{{1, 1}, {0, 2}, {3, 2}});
+	CHECK(set.count(fsv::filtered_string_view{"ushers"}) == 3);
+	CHECK(set.find_first(fsv::filtered_string_view{"ushers"}) == fsv::pattern_match{1, 1});
+	CHECK(not set.find_first(fsv::filtered_string_view{"nothing"}).has_value());
+	CHECK(set.count(fsv::filtered_string_view{}) == 0);
+}
+
+TEST_CASE("Pattern Set - matches span filtered-out bytes and report filtered offsets") {
+	const auto set = fsv::pattern_set{{"error", "warn", "or"}};
+	const auto text = std::string{"e-r-r-o-r ok w-a-r-n"};
+	const auto no_dash = [](const char& c) { return c != '-'; };
+	for (const auto& sv : {fsv::filtered_string_view{text, no_dash},
+	                       fsv::filtered_string_view{text, fsv::pure_filter{no_dash}}})
+	{
+		CHECK(set.find_all(sv) == std::vector<fsv::pattern_match>{{0, 0}, {2, 3}, {1, 9}});
+		CHECK(set.count(sv) == 3);
+		CHECK(set.find_first(sv) == fsv::pattern_match{0, 0});
+	}
+}
+
+TEST_CASE("Pattern Set - agrees with std::string::find on many patterns") {
+	auto text = std::string{};
+	auto state = std::uint32_t{77};
+	for (auto i = 0; i < 20000; ++i) {
+		state = state * 1103515245U + 12345U;
+		text += static_cast<char>('a' + (state >> 16U) % 4U);
+	}
+	auto patterns = std::vector<std::string>{"a", "ab", "abc", "bca", "dddd", "cab", "abcdabcd", "ab"};
+	for (auto i = 0; i < 200; ++i) {
+		patterns.push_back(text.substr(static_cast<std::size_t>(i) * 97, 3 + static_cast<std::size_t>(i) % 6));
+	}
+	patterns.push_back(std::string{"\xff\x80"});
+	const auto set = fsv::pattern_set{patterns};
+	const auto sv = fsv::filtered_string_view{text};
+	const auto expected = brute_force(text, patterns);
+	CHECK(set.find_all(sv) == expected);
+	CHECK(set.count(sv) == expected.size());
+	CHECK(set.patterns() == patterns);
+	CHECK(set.states() > 1);
+}
+
+TEST_CASE("Pattern Set - empty patterns are rejected") {
+	CHECK_THROWS_AS(fsv::pattern_set({"ok", ""}), std::invalid_argument);
+	CHECK(fsv::pattern_set{{}}.count(fsv::filtered_string_view{"anything"}) == 0);
+}
@@ -0,0 +1,92 @@
+#include "./rank_select_index.h"
+
+#include <algorithm>
+#include <bit>
+
+namespace {
+	/**
+	 * Returns the position of the n-th (0-based) set bit of word.
+	 *
+	 * @param word A word with more than n set bits.
+	 * @param n The rank of the bit to locate.
+	 * @return The bit position, counting from the least significant bit.
+	 */
+	auto select_in_word(std::uint64_t word, std::size_t n) noexcept -> std::size_t {
+		for (; n != 0; --n) {
+			word &= word - 1;
+		}
+		return static_cast<std::size_t>(std::countr_zero(word));
+	}
+} // namespace
+
+// Constructor
+fsv::detail::rank_select_index::rank_select_index(const char* first,
+                                                  std::size_t count,
+                                                  const std::function<bool(const char&)>& predicate)
+: raw_bytes_{count}
+, kept_{0}
+, words_((count + word_bits - 1) / word_bits, 0)
+, block_ranks_{}
+, build_time_{} {
+	const auto start = std::chrono::steady_clock::now();
+
+	for (auto i = std::size_t{0}; i < count; ++i) {
+		if (predicate(first[i])) {
+			words_[i / word_bits] |= std::uint64_t{1} << (i % word_bits);
+		}
+	}
+
+	block_ranks_.reserve(words_.size() / block_words + 1);
+	for (auto w = std::size_t{0}; w < words_.size(); ++w) {
+		if (w % block_words == 0) {
+			block_ranks_.push_back(kept_);
+		}
+		kept_ += static_cast<std::size_t>(std::popcount(words_[w]));
+	}
+
+	build_time_ = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+}
+
+// Member Function - kept
+auto fsv::detail::rank_select_index::kept() const noexcept -> std::size_t {
+	return kept_;
+}
+
+// Member Function - rank
+auto fsv::detail::rank_select_index::rank(std::size_t raw) const noexcept -> std::size_t {
+	if (raw >= raw_bytes_) {
+		return kept_;
+	}
+	const auto word = raw / word_bits;
+	auto result = block_ranks_[word / block_words];
+	for (auto w = word - word % block_words; w < word; ++w) {
+		result += static_cast<std::size_t>(std::popcount(words_[w]));
+	}
+	const auto low_bits = (std::uint64_t{1} << (raw % word_bits)) - 1;
+	return result + static_cast<std::size_t>(std::popcount(words_[word] & low_bits));
+}
+
+// Member Function - select
+auto fsv::detail::rank_select_index::select(std::size_t n) const noexcept -> std::size_t {
+	if (n >= kept_) {
+		return raw_bytes_;
+	}
+	// The block holding the n-th kept byte is the last one whose prefix count is <= n.
+	const auto block_it = std::upper_bound(block_ranks_.begin(), block_ranks_.end(), n) - 1;
+	auto remaining = n - *block_it;
+	auto word = static_cast<std::size_t>(block_it - block_ranks_.begin()) * block_words;
+	for (;; ++word) {
+		const auto count = static_cast<std::size_t>(std::popcount(words_[word]));
+		if (remaining < count) {
+			break;
+		}
+		remaining -= count;
+	}
+	return word * word_bits + select_in_word(words_[word], remaining);
+}
+
+// Member Function - stats
+auto fsv::detail::rank_select_index::stats() const noexcept -> index_stats {
+	const auto memory = words_.capacity() * sizeof(std::uint64_t) + block_ranks_.capacity() * sizeof(std::size_t);
+	return index_stats{raw_bytes_, kept_, memory, build_time_};
+}
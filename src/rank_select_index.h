@@ -0,0 +1,49 @@
+#ifndef COMP6771_ASS2_RANK_SELECT_INDEX_H
+#define COMP6771_ASS2_RANK_SELECT_INDEX_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+namespace fsv {
+	// Cost of building a rank/select index, as reported by filtered_string_view::index_stats()
+	struct index_stats {
+		std::size_t raw_bytes;
+		std::size_t kept;
+		std::size_t memory_bytes;
+		std::chrono::nanoseconds build_time;
+	};
+
+	namespace detail {
+		/**
+		 * A bit-packed mask of the kept bytes of a raw range, with a popcount prefix sum
+		 * stored once per block of 512 bits.
+		 *
+		 * rank(raw) answers "how many kept bytes are in [0, raw)" in constant time and
+		 * select(n) answers "which raw offset holds the n-th kept byte" in logarithmic time.
+		 */
+		class rank_select_index {
+		 public:
+			static constexpr std::size_t word_bits = 64;
+			static constexpr std::size_t block_words = 8;
+
+			rank_select_index(const char* first, std::size_t count, const std::function<bool(const char&)>& predicate);
+
+			[[nodiscard]] auto kept() const noexcept -> std::size_t;
+			[[nodiscard]] auto rank(std::size_t raw) const noexcept -> std::size_t;
+			[[nodiscard]] auto select(std::size_t n) const noexcept -> std::size_t;
+			[[nodiscard]] auto stats() const noexcept -> index_stats;
+
+		 private:
+			std::size_t raw_bytes_;
+			std::size_t kept_;
+			std::vector<std::uint64_t> words_;
+			std::vector<std::size_t> block_ranks_;
+			std::chrono::nanoseconds build_time_;
+		};
+	} // namespace detail
+} // namespace fsv
+
+#endif // COMP6771_ASS2_RANK_SELECT_INDEX_H
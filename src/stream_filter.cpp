@@ -0,0 +1,93 @@
+#include "./stream_filter.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <future>
+#include <memory>
+#include <new>
+#include <system_error>
+#include <utility>
+
+#include <unistd.h>
+
+namespace {
+	// Chunks start on a cache line, which keeps the vector kernels' loads from splitting lines.
+	constexpr auto chunk_alignment = std::align_val_t{64};
+
+	struct aligned_delete {
+		auto operator()(char* chunk) const noexcept -> void {
+			::operator delete[](chunk, chunk_alignment);
+		}
+	};
+
+	using chunk_buffer = std::unique_ptr<char[], aligned_delete>;
+
+	auto make_chunk(std::size_t size) -> chunk_buffer {
+		return chunk_buffer{static_cast<char*>(::operator new[](size, chunk_alignment))};
+	}
+
+	/**
+	 * Runs read_chunk on a second thread to fill one chunk while the other is filtered, then
+	 * swaps them, until read_chunk reports that nothing is left.
+	 *
+	 * @param read_chunk Fills [chunk, chunk + size) as far as it can and returns how much it
+	 *                   filled, which is less than size only at the end of the input.
+	 */
+	template<typename ReadChunk>
+	auto double_buffered(ReadChunk read_chunk,
+	                     const fsv::filtered_string_view& fsv,
+	                     const fsv::run_sink& sink,
+	                     std::size_t chunk_size) -> std::size_t {
+		chunk_size = std::max(chunk_size, std::size_t{1});
+		auto current = make_chunk(chunk_size);
+		auto next = make_chunk(chunk_size);
+
+		auto kept = std::size_t{0};
+		auto filled = read_chunk(current.get(), chunk_size);
+		while (filled != 0) {
+			auto reading = filled == chunk_size
+			                   ? std::async(std::launch::async, read_chunk, next.get(), chunk_size)
+			                   : std::future<std::size_t>{};
+			for (const auto run : fsv.rebind(current.get(), filled).chunks()) {
+				sink(run);
+				kept += run.size();
+			}
+			filled = reading.valid() ? reading.get() : 0;
+			std::swap(current, next);
+		}
+		return kept;
+	}
+} // namespace
+
+// Stream Filter - File Descriptor
+auto fsv::filter_stream(int fd, const filtered_string_view& fsv, const run_sink& sink, std::size_t chunk_size)
+    -> std::size_t {
+	const auto read_chunk = [fd](char* chunk, std::size_t size) -> std::size_t {
+		auto filled = std::size_t{0};
+		while (filled < size) {
+			const auto result = ::read(fd, chunk + filled, size - filled);
+			if (result == 0) {
+				break;
+			}
+			if (result < 0) {
+				if (errno == EINTR) {
+					continue;
+				}
+				throw std::system_error{errno, std::generic_category(), "fsv::filter_stream"};
+			}
+			filled += static_cast<std::size_t>(result);
+		}
+		return filled;
+	};
+	return double_buffered(read_chunk, fsv, sink, chunk_size);
+}
+
+// Stream Filter - Input Stream
+auto fsv::filter_stream(std::istream& in, const filtered_string_view& fsv, const run_sink& sink, std::size_t chunk_size)
+    -> std::size_t {
+	const auto read_chunk = [&in](char* chunk, std::size_t size) -> std::size_t {
+		in.read(chunk, static_cast<std::streamsize>(size));
+		return static_cast<std::size_t>(in.gcount());
+	};
+	return double_buffered(read_chunk, fsv, sink, chunk_size);
+}
@@ -0,0 +1,42 @@
+#ifndef COMP6771_ASS2_STREAM_FILTER_H
+#define COMP6771_ASS2_STREAM_FILTER_H
+
+#include <cstddef>
+#include <functional>
+#include <istream>
+#include <span>
+
+#include "./filtered_string_view.h"
+
+namespace fsv {
+	// Receives runs of kept bytes in input order. A run is only valid for the duration of the call.
+	using run_sink = std::function<void(std::span<const char>)>;
+
+	inline constexpr auto default_stream_chunk = std::size_t{1} << 20U;
+
+	/**
+	 * Filters an input of any length through fsv's predicate while holding only two chunks of
+	 * it in memory. One chunk is read on a second thread while the kept runs of the other are
+	 * found, through the same compiled predicate and SIMD kernels as fsv.chunks(), and passed
+	 * to sink. A run of kept bytes that crosses a chunk boundary arrives as two runs.
+	 *
+	 * @param fd The file descriptor to read to its end.
+	 * @param fsv The view whose predicate is applied; its own bytes are ignored.
+	 * @param sink Called once per run of kept bytes.
+	 * @param chunk_size The number of bytes read at a time.
+	 * @return The number of kept bytes passed to sink.
+	 * @throws std::system_error if reading fails, or whatever sink throws.
+	 */
+	auto filter_stream(int fd,
+	                   const filtered_string_view& fsv,
+	                   const run_sink& sink,
+	                   std::size_t chunk_size = default_stream_chunk) -> std::size_t;
+
+	// As above, reading in until it reaches end of file.
+	auto filter_stream(std::istream& in,
+	                   const filtered_string_view& fsv,
+	                   const run_sink& sink,
+	                   std::size_t chunk_size = default_stream_chunk) -> std::size_t;
+} // namespace fsv
+
+#endif // COMP6771_ASS2_STREAM_FILTER_H
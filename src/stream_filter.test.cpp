@@ -0,0 +1,72 @@
+#include "./stream_filter.h"
+
+#include <catch2/catch.hpp>
+#include <sstream>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+	auto make_input(std::size_t lines) -> std::string {
+		auto input = std::string{};
+		for (auto i = std::size_t{0}; i < lines; ++i) {
+			input += "line " + std::to_string(i) + "\r\n";
+		}
+		return input;
+	}
+
+	auto no_cr(const char& c) -> bool {
+		return c != '\r';
+	}
+} // namespace
+
+TEST_CASE("Stream Filter - istream matches the in-memory view") {
+	const auto input = make_input(1000);
+	const auto expected = static_cast<std::string>(fsv::filtered_string_view{input, no_cr});
+	for (const auto& fsv : {fsv::filtered_string_view{"", no_cr}, fsv::filtered_string_view{"", fsv::pure_filter{no_cr}}}) {
+		for (const auto chunk_size : {std::size_t{1}, std::size_t{7}, std::size_t{4096}, fsv::default_stream_chunk}) {
+			auto in = std::istringstream{input};
+			auto output = std::string{};
+			const auto kept = fsv::filter_stream(in, fsv, [&output](std::span<const char> run) {
+				CHECK(!run.empty());
+				output.append(run.begin(), run.end());
+			}, chunk_size);
+			CHECK(kept == expected.size());
+			CHECK(output == expected);
+		}
+	}
+}
+
+TEST_CASE("Stream Filter - reads a pipe to its end") {
+	const auto input = make_input(20000);
+	int ends[2];
+	REQUIRE(::pipe(ends) == 0);
+	auto writer = std::thread{[&input, write_end = ends[1]] {
+		auto written = std::size_t{0};
+		while (written < input.size()) {
+			const auto result = ::write(write_end, input.data() + written, input.size() - written);
+			if (result <= 0) {
+				break;
+			}
+			written += static_cast<std::size_t>(result);
+		}
+		::close(write_end);
+	}};
+	auto output = std::string{};
+	const auto fsv = fsv::filtered_string_view{"", fsv::pure_filter{no_cr}};
+	const auto kept =
+	    fsv::filter_stream(ends[0], fsv, [&output](std::span<const char> run) { output.append(run.begin(), run.end()); }, 1000);
+	writer.join();
+	::close(ends[0]);
+	CHECK(output == static_cast<std::string>(fsv::filtered_string_view{input, no_cr}));
+	CHECK(kept == output.size());
+}
+
+TEST_CASE("Stream Filter - empty input and read errors") {
+	auto in = std::istringstream{};
+	auto calls = 0;
+	CHECK(fsv::filter_stream(in, fsv::filtered_string_view{}, [&calls](std::span<const char>) { ++calls; }) == 0);
+	CHECK(calls == 0);
+	CHECK_THROWS_AS(fsv::filter_stream(-1, fsv::filtered_string_view{}, [](std::span<const char>) {}), std::system_error);
+}